@@ -0,0 +1,143 @@
+#include "Bitboard.hpp"
+#include <mutex>
+
+namespace Chess::Bitboards {
+    Magic rookMagics[64];
+    Magic bishopMagics[64];
+    Bitboard knightAttacks[64];
+    Bitboard kingAttacks[64];
+    Bitboard pawnAttacks[2][64];
+    Bitboard between[64][64];
+    Bitboard line[64][64];
+
+    namespace {
+        // Every occupancy subset of every square shares one table per slider kind
+        Bitboard rookTable[0x19000];
+        Bitboard bishopTable[0x1480];
+
+        const int rookDirs[4][2] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
+        const int bishopDirs[4][2] = { {1,1}, {1,-1}, {-1,1}, {-1,-1} };
+
+        // Ray walk used only to fill the tables
+        Bitboard slidingAttacks(int sq, Bitboard occupied, const int dirs[4][2]) {
+            Bitboard attacks = 0;
+            for (int d = 0; d < 4; ++d) {
+                int x = fileOf(sq) + dirs[d][0], y = rankOf(sq) + dirs[d][1];
+                while (x >= 0 && x < 8 && y >= 0 && y < 8) {
+                    Bitboard bb = squareBB(makeSquare(x, y));
+                    attacks |= bb;
+                    if (occupied & bb)
+                        break;
+                    x += dirs[d][0]; y += dirs[d][1];
+                }
+            }
+            return attacks;
+        }
+
+        Bitboard leaperAttacks(int sq, const int (*offsets)[2], int count) {
+            Bitboard attacks = 0;
+            for (int i = 0; i < count; ++i) {
+                int x = fileOf(sq) + offsets[i][0], y = rankOf(sq) + offsets[i][1];
+                if (x >= 0 && x < 8 && y >= 0 && y < 8)
+                    attacks |= squareBB(makeSquare(x, y));
+            }
+            return attacks;
+        }
+
+        void initLeapers() {
+            const int knightOffsets[8][2] = { {2,1}, {1,2}, {-1,2}, {-2,1}, {-2,-1}, {-1,-2}, {1,-2}, {2,-1} };
+            const int kingOffsets[8][2] = { {1,0}, {1,1}, {0,1}, {-1,1}, {-1,0}, {-1,-1}, {0,-1}, {1,-1} };
+            const int whitePawnOffsets[2][2] = { {-1,1}, {1,1} };
+            const int blackPawnOffsets[2][2] = { {-1,-1}, {1,-1} };
+            for (int sq = 0; sq < 64; ++sq) {
+                knightAttacks[sq] = leaperAttacks(sq, knightOffsets, 8);
+                kingAttacks[sq] = leaperAttacks(sq, kingOffsets, 8);
+                pawnAttacks[0][sq] = leaperAttacks(sq, whitePawnOffsets, 2);
+                pawnAttacks[1][sq] = leaperAttacks(sq, blackPawnOffsets, 2);
+            }
+        }
+
+        // xorshift64*, seeded per rank so the magics are found in a few tries
+        struct Prng {
+            uint64_t s;
+            uint64_t next() {
+                s ^= s >> 12; s ^= s << 25; s ^= s >> 27;
+                return s * 2685821657736338717ULL;
+            }
+            uint64_t sparse() { return next() & next() & next(); }
+        };
+
+        void initMagics(Magic magics[64], Bitboard* table, const int dirs[4][2]) {
+            const uint64_t seeds[8] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+            Bitboard occupancy[4096], reference[4096];
+            int epoch[4096] = {}, attempt = 0;
+
+            for (int sq = 0; sq < 64; ++sq) {
+                // Edge squares never block a ray, so they are left out of the mask
+                Bitboard edges = ((RANK_1_BB | RANK_8_BB) & ~(RANK_1_BB << (8 * rankOf(sq))))
+                    | ((FILE_A_BB | FILE_H_BB) & ~(FILE_A_BB << fileOf(sq)));
+                Magic& m = magics[sq];
+                m.mask = slidingAttacks(sq, 0, dirs) & ~edges;
+                m.shift = 64 - popCount(m.mask);
+                m.attacks = sq == 0 ? table : magics[sq - 1].attacks + (size_t(1) << (64 - magics[sq - 1].shift));
+
+                // Carry-Rippler enumeration of every subset of the mask
+                int size = 0;
+                Bitboard b = 0;
+                do {
+                    occupancy[size] = b;
+                    reference[size] = slidingAttacks(sq, b, dirs);
+                    ++size;
+                    b = (b - m.mask) & m.mask;
+                } while (b);
+
+                Prng rng{ seeds[rankOf(sq)] };
+                for (int i = 0; i < size;) {
+                    for (m.magic = 0; popCount((m.magic * m.mask) >> 56) < 6;)
+                        m.magic = rng.sparse();
+
+                    // Versioned check so the table does not need clearing between attempts
+                    ++attempt;
+                    for (i = 0; i < size; ++i) {
+                        unsigned idx = m.index(occupancy[i]);
+                        if (epoch[idx] < attempt) {
+                            epoch[idx] = attempt;
+                            m.attacks[idx] = reference[i];
+                        }
+                        else if (m.attacks[idx] != reference[i])
+                            break;
+                    }
+                }
+            }
+        }
+
+        // Line and between sets follow from empty-board slider attacks
+        void initLines() {
+            for (int s1 = 0; s1 < 64; ++s1) {
+                for (int s2 = 0; s2 < 64; ++s2) {
+                    if (s1 == s2)
+                        continue;
+                    Bitboard pair = squareBB(s1) | squareBB(s2);
+                    if (rookAttacks(s1, 0) & squareBB(s2)) {
+                        line[s1][s2] = (rookAttacks(s1, 0) & rookAttacks(s2, 0)) | pair;
+                        between[s1][s2] = rookAttacks(s1, squareBB(s2)) & rookAttacks(s2, squareBB(s1));
+                    }
+                    else if (bishopAttacks(s1, 0) & squareBB(s2)) {
+                        line[s1][s2] = (bishopAttacks(s1, 0) & bishopAttacks(s2, 0)) | pair;
+                        between[s1][s2] = bishopAttacks(s1, squareBB(s2)) & bishopAttacks(s2, squareBB(s1));
+                    }
+                }
+            }
+        }
+    }
+
+    void init() {
+        static std::once_flag once;
+        std::call_once(once, [] {
+            initLeapers();
+            initMagics(rookMagics, rookTable, rookDirs);
+            initMagics(bishopMagics, bishopTable, bishopDirs);
+            initLines();
+        });
+    }
+} // namespace Chess::Bitboards
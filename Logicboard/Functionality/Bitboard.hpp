@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <bit>
+
+namespace Chess {
+    // One bit per square, a1 = bit 0, h8 = bit 63 (rank-major, from White's side)
+    using Bitboard = uint64_t;
+
+    constexpr int makeSquare(int file, int rank) { return rank * 8 + file; }
+    constexpr int fileOf(int sq) { return sq & 7; }
+    constexpr int rankOf(int sq) { return sq >> 3; }
+
+    constexpr Bitboard FILE_A_BB = 0x0101010101010101ULL;
+    constexpr Bitboard FILE_H_BB = FILE_A_BB << 7;
+    constexpr Bitboard RANK_1_BB = 0xFFULL;
+    constexpr Bitboard RANK_3_BB = RANK_1_BB << 16;
+    constexpr Bitboard RANK_6_BB = RANK_1_BB << 40;
+    constexpr Bitboard RANK_8_BB = RANK_1_BB << 56;
+
+    constexpr Bitboard squareBB(int sq) { return Bitboard(1) << sq; }
+    inline int lsb(Bitboard b) { return std::countr_zero(b); }
+    inline int popCount(Bitboard b) { return std::popcount(b); }
+    inline int popLsb(Bitboard& b) {
+        int sq = lsb(b);
+        b &= b - 1;
+        return sq;
+    }
+
+    // Fancy magic bitboards: attacks[((occupied & mask) * magic) >> shift] is the
+    // attack set of a slider on this square for any occupancy
+    struct Magic {
+        Bitboard mask;
+        Bitboard magic;
+        Bitboard* attacks;
+        unsigned shift;
+
+        unsigned index(Bitboard occupied) const {
+            return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+        }
+    };
+
+    namespace Bitboards {
+        // Builds the attack tables, safe to call more than once
+        void init();
+
+        extern Magic rookMagics[64];
+        extern Magic bishopMagics[64];
+        extern Bitboard knightAttacks[64];
+        extern Bitboard kingAttacks[64];
+        extern Bitboard pawnAttacks[2][64]; // [0] white, [1] black
+        extern Bitboard between[64][64];    // squares strictly between two aligned squares
+        extern Bitboard line[64][64];       // the whole rank, file or diagonal through both
+    }
+
+    inline Bitboard knightAttacks(int sq) { return Bitboards::knightAttacks[sq]; }
+    inline Bitboard kingAttacks(int sq) { return Bitboards::kingAttacks[sq]; }
+    inline Bitboard pawnAttacks(int colorIdx, int sq) { return Bitboards::pawnAttacks[colorIdx][sq]; }
+    inline Bitboard betweenBB(int s1, int s2) { return Bitboards::between[s1][s2]; }
+    inline Bitboard lineBB(int s1, int s2) { return Bitboards::line[s1][s2]; }
+
+    inline Bitboard rookAttacks(int sq, Bitboard occupied) {
+        const Magic& m = Bitboards::rookMagics[sq];
+        return m.attacks[m.index(occupied)];
+    }
+    inline Bitboard bishopAttacks(int sq, Bitboard occupied) {
+        const Magic& m = Bitboards::bishopMagics[sq];
+        return m.attacks[m.index(occupied)];
+    }
+    inline Bitboard queenAttacks(int sq, Bitboard occupied) {
+        return rookAttacks(sq, occupied) | bishopAttacks(sq, occupied);
+    }
+} // namespace Chess
@@ -0,0 +1,43 @@
+#pragma once
+#include "Chess.hpp"
+#include "MappedFile.hpp"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Chess {
+    // Polyglot opening book (.bin): 16-byte big-endian entries (key, move, weight, learn) sorted
+    // by position key. The file is memory-mapped and binary-searched in place, so opening costs
+    // nothing however large the book is and the pages are shared with every other process using it.
+    class OpeningBook {
+    public:
+        struct BookMove {
+            PackedMove move;
+            uint16_t weight;
+        };
+
+        OpeningBook() : rng(std::random_device{}()) {}
+
+        // Replaces any open book; false (no book open) if the file is missing or not a whole number of entries
+        bool open(const std::string& path);
+        void close() { file.close(); }
+        bool isOpen() const { return file.isOpen(); }
+        size_t size() const { return file.size() / ENTRY_BYTES; }
+
+        // The book's moves for the position that are legal in it, in file order
+        void probe(const Board& board, std::vector<BookMove>& moves) const;
+        // A book move drawn with probability proportional to its weight; null when out of book
+        PackedMove pick(const Board& board);
+
+        // Polyglot position key, unrelated to Board::hash(): the book's own random numbers and
+        // an en passant term only when a pawn of the side to move stands beside the pushed pawn
+        static uint64_t key(const Board& board);
+
+    private:
+        static constexpr size_t ENTRY_BYTES = 16;
+
+        MappedFile file;
+        std::mt19937_64 rng;
+    };
+} // namespace Chess
@@ -1,133 +1,348 @@
 #include "Chess.hpp"
+#include <iostream>
+#include <sstream>
+#include <cctype>
+#include <utility>
 using namespace Chess;
-extern Networking::NetworkManager netMgr;
-extern PieceColor localPlayerColor;
 Board::Board() {
+    Bitboards::init();
+    Zobrist::init();
+    PSQT::init();
+    createPieceViews();
+    history.reserve(512);
     resetBoard();
 }
 
-void Board::makeMove(Position from, Position to, std::vector<std::unique_ptr<Piece>>& takenPieces) {
-    auto& piece = grid[from.x][from.y];
-    auto& dest = grid[to.x][to.y];
+Board::Board(const Board& other) {
+    createPieceViews();
+    *this = other;
+}
 
-    if (gameState == GameState::PAUSED)
+Board& Board::operator=(const Board& other) {
+    if (this == &other)
+        return *this;
+    currentTurn = other.currentTurn;
+    gameState = other.gameState;
+    lastMove = other.lastMove;
+    pieceBB = other.pieceBB;
+    colorBB = other.colorBB;
+    occupied = other.occupied;
+    mailbox = other.mailbox;
+    kingSquare = other.kingSquare;
+    castlingRights = other.castlingRights;
+    epSquare = other.epSquare;
+    halfmoveClock = other.halfmoveClock;
+    history = other.history;
+    hashKey = other.hashKey;
+    pawnKey = other.pawnKey;
+    psq = other.psq;
+    phase = other.phase;
+    return *this;
+}
+
+void Board::createPieceViews() {
+    pieceViews[0] = std::make_unique<EmptyPiece>(this);
+    for (PieceColor c : { PieceColor::WHITE, PieceColor::BLACK }) {
+        pieceViews[pieceCode(c, PieceType::PAWN)] = std::make_unique<Pawn>(c, this);
+        pieceViews[pieceCode(c, PieceType::KNIGHT)] = std::make_unique<Knight>(c, this);
+        pieceViews[pieceCode(c, PieceType::BISHOP)] = std::make_unique<Bishop>(c, this);
+        pieceViews[pieceCode(c, PieceType::ROOK)] = std::make_unique<Rook>(c, this);
+        pieceViews[pieceCode(c, PieceType::QUEEN)] = std::make_unique<Queen>(c, this);
+        pieceViews[pieceCode(c, PieceType::KING)] = std::make_unique<King>(c, this);
+    }
+}
+
+void Board::putPiece(int sq, uint8_t code) {
+    Bitboard bb = squareBB(sq);
+    mailbox[sq] = code;
+    pieceBB[code] |= bb;
+    colorBB[colorIndex(codeColor(code))] |= bb;
+    occupied |= bb;
+    psq += PSQT::table[code][sq];
+    phase += PSQT::phaseWeight[static_cast<int>(codeType(code))];
+    if (codeType(code) == PieceType::PAWN)
+        pawnKey ^= Zobrist::pieceSquare[code][sq];
+    if (codeType(code) == PieceType::KING)
+        kingSquare[colorIndex(codeColor(code))] = sq;
+}
+
+void Board::removePiece(int sq) {
+    Bitboard bb = squareBB(sq);
+    uint8_t code = mailbox[sq];
+    if (code == 0)
         return;
+    mailbox[sq] = 0;
+    pieceBB[code] ^= bb;
+    colorBB[colorIndex(codeColor(code))] ^= bb;
+    occupied ^= bb;
+    psq -= PSQT::table[code][sq];
+    phase -= PSQT::phaseWeight[static_cast<int>(codeType(code))];
+    if (codeType(code) == PieceType::PAWN)
+        pawnKey ^= Zobrist::pieceSquare[code][sq];
+    if (codeType(code) == PieceType::KING)
+        kingSquare[colorIndex(codeColor(code))] = -1;
+}
 
-    std::vector<Move> legalMoves = piece->getLegalMoves(from);
-	std::cout << "Legal moves for piece at (" << from.x << ", " << from.y << "):\n";
-    for (const Move& move : legalMoves) {
-        std::cout << "  To (" << move.to.x << ", " << move.to.y << ")\n";
+void Board::movePiece(int from, int to) {
+    uint8_t code = mailbox[from];
+    Bitboard fromTo = squareBB(from) | squareBB(to);
+    mailbox[to] = code;
+    mailbox[from] = 0;
+    pieceBB[code] ^= fromTo;
+    colorBB[colorIndex(codeColor(code))] ^= fromTo;
+    occupied ^= fromTo;
+    psq += PSQT::table[code][to] - PSQT::table[code][from];
+    if (codeType(code) == PieceType::PAWN)
+        pawnKey ^= Zobrist::pieceSquare[code][from] ^ Zobrist::pieceSquare[code][to];
+    if (codeType(code) == PieceType::KING)
+        kingSquare[colorIndex(codeColor(code))] = to;
+}
+
+namespace {
+    // Rights that survive a move touching this square
+    constexpr std::array<uint8_t, 64> castlingMask = [] {
+        std::array<uint8_t, 64> mask{};
+        mask.fill(ALL_CASTLING);
+        mask[makeSquare(4, 0)] &= ~(WHITE_OO | WHITE_OOO);
+        mask[makeSquare(7, 0)] &= ~WHITE_OO;
+        mask[makeSquare(0, 0)] &= ~WHITE_OOO;
+        mask[makeSquare(4, 7)] &= ~(BLACK_OO | BLACK_OOO);
+        mask[makeSquare(7, 7)] &= ~BLACK_OO;
+        mask[makeSquare(0, 7)] &= ~BLACK_OOO;
+        return mask;
+    }();
+
+    // Rook squares for a castling king landing on g- or c-file
+    inline void castlingRookSquares(int kingTo, int& rookFrom, int& rookTo) {
+        bool kingSide = fileOf(kingTo) == 6;
+        rookFrom = kingTo + (kingSide ? 1 : -2);
+        rookTo = kingTo + (kingSide ? -1 : 1);
     }
-    if (legalMoves.size() == 0) {
-		return;
-	}
-	Move usedMove;
+}
+
+void Board::doMove(PackedMove move) {
+    int from = move.from();
+    int to = move.to();
+    MoveType type = move.type();
+    uint8_t code = mailbox[from];
+    int captureSq = type == MoveType::EN_PASSANT ? makeSquare(fileOf(to), rankOf(from)) : to;
+
+    UndoInfo& undo = history.emplace_back();
+    undo.move = move;
+    undo.captured = mailbox[captureSq];
+    undo.castlingRights = castlingRights;
+    undo.epSquare = static_cast<int8_t>(epSquare);
+    undo.halfmoveClock = static_cast<uint8_t>(halfmoveClock);
+    undo.hash = hashKey;
+
+    uint64_t key = hashKey ^ Zobrist::side;
+    if (epSquare >= 0)
+        key ^= Zobrist::enPassant[fileOf(epSquare)];
+
+    if (undo.captured != 0) {
+        key ^= Zobrist::pieceSquare[undo.captured][captureSq];
+        removePiece(captureSq);
+    }
+    movePiece(from, to);
+    key ^= Zobrist::pieceSquare[code][from] ^ Zobrist::pieceSquare[code][to];
+
+    if (type == MoveType::PROMOTION) {
+        uint8_t promoted = pieceCode(currentTurn, move.promotion());
+        removePiece(to);
+        putPiece(to, promoted);
+        key ^= Zobrist::pieceSquare[code][to] ^ Zobrist::pieceSquare[promoted][to];
+    }
+    else if (type == MoveType::CASTLE) {
+        int rookFrom, rookTo;
+        castlingRookSquares(to, rookFrom, rookTo);
+        uint8_t rook = mailbox[rookFrom];
+        movePiece(rookFrom, rookTo);
+        key ^= Zobrist::pieceSquare[rook][rookFrom] ^ Zobrist::pieceSquare[rook][rookTo];
+    }
+
+    // The en passant square is only recorded when an enemy pawn can actually use it,
+    // so transpositions through a harmless double push hash the same
+    bool isPawn = codeType(code) == PieceType::PAWN;
+    epSquare = -1;
+    if (isPawn && (to - from == 16 || from - to == 16)
+        && (pawnAttacks(colorIndex(currentTurn), (from + to) / 2) & pieces(opposite(currentTurn), PieceType::PAWN))) {
+        epSquare = (from + to) / 2;
+        key ^= Zobrist::enPassant[fileOf(epSquare)];
+    }
+
+    uint8_t rights = castlingRights & castlingMask[from] & castlingMask[to];
+    key ^= Zobrist::castling[castlingRights] ^ Zobrist::castling[rights];
+    castlingRights = rights;
+    halfmoveClock = (isPawn || undo.captured != 0) ? 0 : halfmoveClock + 1;
+    currentTurn = opposite(currentTurn);
+    hashKey = key;
+}
+
+void Board::undoMove() {
+    const UndoInfo& undo = history.back();
+    PackedMove move = undo.move;
+    int from = move.from();
+    int to = move.to();
+    MoveType type = move.type();
+    currentTurn = opposite(currentTurn);
+
+    if (type == MoveType::PROMOTION) {
+        removePiece(to);
+        putPiece(to, pieceCode(currentTurn, PieceType::PAWN));
+    }
+    else if (type == MoveType::CASTLE) {
+        int rookFrom, rookTo;
+        castlingRookSquares(to, rookFrom, rookTo);
+        movePiece(rookTo, rookFrom);
+    }
+    movePiece(to, from);
+    if (undo.captured != 0)
+        putPiece(type == MoveType::EN_PASSANT ? makeSquare(fileOf(to), rankOf(from)) : to, undo.captured);
+
+    castlingRights = undo.castlingRights;
+    epSquare = undo.epSquare;
+    halfmoveClock = undo.halfmoveClock;
+    hashKey = undo.hash;
+    history.pop_back();
+}
+
+void Board::doNullMove() {
+    UndoInfo& undo = history.emplace_back();
+    undo.move = PackedMove();
+    undo.captured = 0;
+    undo.castlingRights = castlingRights;
+    undo.epSquare = static_cast<int8_t>(epSquare);
+    undo.halfmoveClock = static_cast<uint8_t>(halfmoveClock);
+    undo.hash = hashKey;
+
+    uint64_t key = hashKey ^ Zobrist::side;
+    if (epSquare >= 0)
+        key ^= Zobrist::enPassant[fileOf(epSquare)];
+    epSquare = -1;
+    halfmoveClock = 0;
+    currentTurn = opposite(currentTurn);
+    hashKey = key;
+}
+
+void Board::undoNullMove() {
+    const UndoInfo& undo = history.back();
+    currentTurn = opposite(currentTurn);
+    epSquare = undo.epSquare;
+    halfmoveClock = undo.halfmoveClock;
+    hashKey = undo.hash;
+    history.pop_back();
+}
+
+uint64_t Board::computeHash() const {
+    uint64_t key = 0;
+    Bitboard b = occupied;
+    while (b) {
+        int sq = popLsb(b);
+        key ^= Zobrist::pieceSquare[mailbox[sq]][sq];
+    }
+    if (currentTurn == PieceColor::BLACK)
+        key ^= Zobrist::side;
+    if (epSquare >= 0)
+        key ^= Zobrist::enPassant[fileOf(epSquare)];
+    return key ^ Zobrist::castling[castlingRights];
+}
+
+uint64_t Board::computePawnHash() const {
+    uint64_t key = 0;
+    for (PieceColor c : { PieceColor::WHITE, PieceColor::BLACK }) {
+        Bitboard b = pieces(c, PieceType::PAWN);
+        while (b) {
+            int sq = popLsb(b);
+            key ^= Zobrist::pieceSquare[pieceCode(c, PieceType::PAWN)][sq];
+        }
+    }
+    return key;
+}
+
+Score Board::computePsq() const {
+    Score score;
+    Bitboard b = occupied;
+    while (b) {
+        int sq = popLsb(b);
+        score += PSQT::table[mailbox[sq]][sq];
+    }
+    return score;
+}
+
+int Board::computePhase() const {
+    int sum = 0;
+    Bitboard b = occupied;
+    while (b) {
+        int sq = popLsb(b);
+        sum += PSQT::phaseWeight[static_cast<int>(codeType(mailbox[sq]))];
+    }
+    return sum;
+}
+
+void Board::clear() {
+    pieceBB.fill(0);
+    colorBB.fill(0);
+    occupied = 0;
+    mailbox.fill(0);
+    kingSquare = { -1, -1 };
+    pawnKey = 0;
+    psq = Score();
+    phase = 0;
+}
+
+bool Board::makeMove(Position from, Position to, std::vector<const Piece*>& takenPieces) {
+    if (gameState == GameState::PAUSED)
+        return false;
+
+    // Only strictly legal moves are generated, so no simulation is needed afterwards
+    MoveList legalMoves;
+    generateLegalMoves(legalMoves);
+	std::cout << "Legal moves for piece at (" << from.x << ", " << from.y << "):\n";
+	PackedMove usedMove;
 	bool isLegal = false;
-    for(const Move& move : legalMoves) {
-        if (move.to == to) {
+    int fromSq = makeSquare(from.x, from.y);
+    int toSq = makeSquare(to.x, to.y);
+    for (PackedMove move : legalMoves) {
+        if (move.from() != fromSq)
+            continue;
+        std::cout << "  To (" << fileOf(move.to()) << ", " << rankOf(move.to()) << ")\n";
+        if (move.to() == toSq && !isLegal) {
 			usedMove = move;
 			isLegal = true;
-            break;
         }
 	}
-    if (!isLegal) return;
-    // Simulate the move
-    auto capturedPiece = std::move(dest);
-    dest = std::move(piece);
-    piece = std::make_unique<EmptyPiece>(this);
-    bool stillInCheck = isChecked(currentTurn);
-    // Revert the move
-    piece = std::move(dest);
-    dest = std::move(capturedPiece);
-    if (stillInCheck) {
-        std::cout << "Move would leave king in check, illegal move.\n";
-        return; // Move is illegal as it leaves king in check
-	}
+    if (!isLegal) return false;
     std::cout << "Move made from (" << from.x << ", " << from.y << ") to ("
 		<< to.x << ", " << to.y << ")\n";
-    if(usedMove.type == MoveType::CAPTURE)
-		takenPieces.push_back(std::move(dest));
-    dest = std::move(piece);
-    lastMove = usedMove;
-    // Leave an empty piece at the original square
-    
-    piece = std::make_unique<EmptyPiece>(this);
-	currentTurn = (currentTurn == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+    applyMove(usedMove, takenPieces);
 	
 	std::cout << "taken pieces count: " << takenPieces.size() << "\n";
 	updateGameState();
-    if (netMgr.isConnected()) {
-        netMgr.sendData<GameInfo>({ lastMove, gameState, currentTurn });
-    }
-
-
+    return true;
 }
 
-bool Board::isSquareAttacked(Position pos, PieceColor attackerColor) const {
-    // Iterate over all squares on the board
-    for (int x = 0; x < 8; ++x) {
-        for (int y = 0; y < 8; ++y) {
-            Piece* piece = getPiece(x,y);
-            // Check if the piece belongs to the attacking color
-            if (piece->getColor() == attackerColor) {
-                Position from{x, y};
-                std::vector<Move> moves = piece->getLegalMoves(from);
-                // Check if any of the legal moves target the specified position
-                for (const Move& move : moves) {
-                    if (move.to == pos) {
-                        return true; // The square is attacked
-                    }
-                }
-            }
-        }
-    }
-    return false; // No attacking pieces found
+void Board::applyMove(PackedMove move, std::vector<const Piece*>& takenPieces) {
+    doMove(move);
+    if (history.back().captured != 0)
+        takenPieces.push_back(pieceViews[history.back().captured].get());
+    lastMove = move;
 }
 
 Position Board::kingPosition(PieceColor kingColor) const {
-    for(int x = 0; x < 8; ++x) {
-        for(int y = 0; y < 8; ++y) {
-            Piece* piece = getPiece(x,y);
-            if (piece->getType() == PieceType::KING && piece->getColor() == kingColor) {
-                return Position{x,y};
-            }
-        }
-	}
+    int sq = kingSquareOf(kingColor);
+    return sq < 0 ? Position() : Position(fileOf(sq), rankOf(sq));
 }
 bool Board::isChecked(PieceColor kingColor) {
-    bool isCheck = isSquareAttacked(kingPosition(kingColor), kingColor == PieceColor::WHITE ? PieceColor::BLACK : PieceColor::WHITE);
-    return isCheck;
+    int sq = kingSquareOf(kingColor);
+    return sq >= 0 && isSquareAttacked(sq, opposite(kingColor));
 }
 
 void Board::updateGameState() {
     bool inCheck = isChecked(currentTurn);
-    bool hasLegalMoves = false;
     // Check for any legal moves for the current player
-    for (int x = 0; x < 8; ++x) {
-        for (int y = 0; y < 8; ++y) {
-            Piece* piece = getPiece(x, y);
-            if (piece->getColor() == currentTurn) {
-                Position from{x, y};
-                std::vector<Move> moves = piece->getLegalMoves(from);
-                for (const Move& move : moves) {
-                    // Simulate the move
-                    auto capturedPiece = std::move(grid[move.to.x][move.to.y]);
-                    grid[move.to.x][move.to.y] = std::move(grid[from.x][from.y]);
-                    grid[from.x][from.y] = std::make_unique<EmptyPiece>(this);
-                    bool stillInCheck = isChecked(currentTurn);
-                    // Revert the move
-                    grid[from.x][from.y] = std::move(grid[move.to.x][move.to.y]);
-                    grid[move.to.x][move.to.y] = std::move(capturedPiece);
-                    if (!stillInCheck) {
-                        hasLegalMoves = true;
-                        break;
-                    }
-                }
-            }
-            if (hasLegalMoves) break;
-        }
-        if (hasLegalMoves) break;
-    }
+    MoveList moves;
+    generateLegalMoves(moves);
+    bool hasLegalMoves = !moves.empty();
     if (inCheck && !hasLegalMoves) {
         gameState = GameState::CHECKMATE;
         gameOver();
@@ -148,49 +363,124 @@ void Board::gameOver() {
 
 
 void Board::resetBoard() {
-    // Fill everything with empty pieces first
-    for (int x = 0; x < 8; ++x)
-        for (int y = 0; y < 8; ++y)
-            grid[x][y] = std::make_unique<EmptyPiece>(this);
-
-    // Place pawns
+    clear();
+    currentTurn = PieceColor::WHITE;
+    castlingRights = ALL_CASTLING;
+    epSquare = -1;
+    halfmoveClock = 0;
+    history.clear();
+
+    const PieceType backRank[8] = {
+        PieceType::ROOK, PieceType::KNIGHT, PieceType::BISHOP, PieceType::QUEEN,
+        PieceType::KING, PieceType::BISHOP, PieceType::KNIGHT, PieceType::ROOK
+    };
     for (int x = 0; x < 8; ++x) {
-        grid[x][1] = std::make_unique<Pawn>(PieceColor::WHITE, this);
-        grid[x][6] = std::make_unique<Pawn>(PieceColor::BLACK, this);
+        putPiece(makeSquare(x, 0), pieceCode(PieceColor::WHITE, backRank[x]));
+        putPiece(makeSquare(x, 1), pieceCode(PieceColor::WHITE, PieceType::PAWN));
+        putPiece(makeSquare(x, 6), pieceCode(PieceColor::BLACK, PieceType::PAWN));
+        putPiece(makeSquare(x, 7), pieceCode(PieceColor::BLACK, backRank[x]));
     }
+    hashKey = computeHash();
+}
 
-    // Place rooks
-    grid[0][0] = std::make_unique<Rook>(PieceColor::WHITE, this);
-    grid[7][0] = std::make_unique<Rook>(PieceColor::WHITE, this);
-    grid[0][7] = std::make_unique<Rook>(PieceColor::BLACK, this);
-    grid[7][7] = std::make_unique<Rook>(PieceColor::BLACK, this);
-
-    // Knights
-    grid[1][0] = std::make_unique<Knight>(PieceColor::WHITE, this);
-    grid[6][0] = std::make_unique<Knight>(PieceColor::WHITE, this);
-    grid[1][7] = std::make_unique<Knight>(PieceColor::BLACK, this);
-    grid[6][7] = std::make_unique<Knight>(PieceColor::BLACK, this);
-
-    // Bishops
-    grid[2][0] = std::make_unique<Bishop>(PieceColor::WHITE, this);
-    grid[5][0] = std::make_unique<Bishop>(PieceColor::WHITE, this);
-    grid[2][7] = std::make_unique<Bishop>(PieceColor::BLACK, this);
-    grid[5][7] = std::make_unique<Bishop>(PieceColor::BLACK, this);
-
-    // Queens
-    grid[3][0] = std::make_unique<Queen>(PieceColor::WHITE, this);
-    grid[3][7] = std::make_unique<Queen>(PieceColor::BLACK, this);
-
-    // Kings
-    grid[4][0] = std::make_unique<King>(PieceColor::WHITE, this);
-    grid[4][7] = std::make_unique<King>(PieceColor::BLACK, this);
-
-    if (localPlayerColor == PieceColor::BLACK) {
-        for(int x = 0; x < 8; ++x) {
-            for(int y = 0; y < 4; ++y) {
-                std::swap(grid[x][y], grid[x][7 - y]);
-            }
-		}
+bool Board::loadFen(const std::string& fen) {
+    std::istringstream in(fen);
+    std::string placement, side, castling, ep;
+    int halfmove = 0;
+    if (!(in >> placement >> side))
+        return false;
+    if (!(in >> castling)) castling = "-";
+    if (!(in >> ep)) ep = "-";
+    if (!(in >> halfmove)) halfmove = 0;
+
+    Board parsed(*this);
+    parsed.clear();
+    int file = 0, rank = 7;
+    for (char c : placement) {
+        if (c == '/') {
+            if (file != 8) return false;
+            file = 0;
+            if (--rank < 0) return false;
+        }
+        else if (c >= '1' && c <= '8') {
+            file += c - '0';
+        }
+        else {
+            static const std::string symbols = "pnbrqk";
+            size_t idx = symbols.find(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+            if (idx == std::string::npos || file > 7) return false;
+            PieceColor color = std::isupper(static_cast<unsigned char>(c)) ? PieceColor::WHITE : PieceColor::BLACK;
+            parsed.putPiece(makeSquare(file++, rank), pieceCode(color, static_cast<PieceType>(idx + 1)));
+        }
+        if (file > 8) return false;
+    }
+    if (rank != 0 || file != 8) return false;
+    if (popCount(parsed.pieces(PieceColor::WHITE, PieceType::KING)) != 1
+        || popCount(parsed.pieces(PieceColor::BLACK, PieceType::KING)) != 1)
+        return false;
+
+    if (side != "w" && side != "b") return false;
+    parsed.currentTurn = side == "w" ? PieceColor::WHITE : PieceColor::BLACK;
+
+    parsed.castlingRights = 0;
+    for (char c : castling) {
+        switch (c) {
+        case 'K': parsed.castlingRights |= WHITE_OO; break;
+        case 'Q': parsed.castlingRights |= WHITE_OOO; break;
+        case 'k': parsed.castlingRights |= BLACK_OO; break;
+        case 'q': parsed.castlingRights |= BLACK_OOO; break;
+        case '-': break;
+        default: return false;
+        }
+    }
+    // A right whose king or rook is not on its home square could never be used, and castling
+    // with it would move a rook that is not there
+    const std::pair<int, uint8_t> homeSquares[] = {
+        { makeSquare(4, 0), pieceCode(PieceColor::WHITE, PieceType::KING) }, { makeSquare(7, 0), pieceCode(PieceColor::WHITE, PieceType::ROOK) },
+        { makeSquare(0, 0), pieceCode(PieceColor::WHITE, PieceType::ROOK) }, { makeSquare(4, 7), pieceCode(PieceColor::BLACK, PieceType::KING) },
+        { makeSquare(7, 7), pieceCode(PieceColor::BLACK, PieceType::ROOK) }, { makeSquare(0, 7), pieceCode(PieceColor::BLACK, PieceType::ROOK) },
+    };
+    for (const auto& [sq, code] : homeSquares)
+        if (parsed.mailbox[sq] != code)
+            parsed.castlingRights &= castlingMask[sq];
+
+    // Same rule as doMove: only keep an en passant square a pawn can capture onto
+    parsed.epSquare = -1;
+    if (ep != "-") {
+        if (ep.size() != 2 || ep[0] < 'a' || ep[0] > 'h' || (ep[1] != '3' && ep[1] != '6'))
+            return false;
+        int sq = makeSquare(ep[0] - 'a', ep[1] - '1');
+        if (pawnAttacks(colorIndex(opposite(parsed.currentTurn)), sq) & parsed.pieces(parsed.currentTurn, PieceType::PAWN))
+            parsed.epSquare = sq;
+    }
+
+    parsed.halfmoveClock = halfmove;
+    parsed.history.clear();
+    parsed.lastMove = PackedMove();
+    parsed.hashKey = parsed.computeHash();
+    *this = parsed;
+    return true;
+}
+
+std::string Chess::moveToUci(PackedMove move) {
+    std::string uci;
+    uci += static_cast<char>('a' + fileOf(move.from()));
+    uci += static_cast<char>('1' + rankOf(move.from()));
+    uci += static_cast<char>('a' + fileOf(move.to()));
+    uci += static_cast<char>('1' + rankOf(move.to()));
+    if (move.type() == MoveType::PROMOTION)
+        uci += "pnbrqk"[static_cast<int>(move.promotion()) - 1];
+    return uci;
+}
+
+// Turns an attack set into moves, skipping squares held by our own pieces
+static void appendTargetMoves(const Board& board, const Position& from, PieceColor color, Bitboard attacks, std::vector<Move>& moves) {
+    Bitboard targets = attacks & ~board.colorBB[colorIndex(color)];
+    Bitboard enemies = board.colorBB[colorIndex(color == PieceColor::WHITE ? PieceColor::BLACK : PieceColor::WHITE)];
+    while (targets) {
+        int to = popLsb(targets);
+        moves.emplace_back(from, Position(fileOf(to), rankOf(to)),
+            (enemies & squareBB(to)) ? MoveType::CAPTURE : MoveType::NORMAL);
     }
 }
 
@@ -199,13 +489,7 @@ std::vector<Move> Pawn::getLegalMoves(const Position& from) const {
     std::vector<Move> moves;
 
 
-    int dir;
-    if (localPlayerColor == PieceColor::WHITE) {
-        dir = (color == PieceColor::WHITE) ? 1 : -1;
-    }
-    else {
-        dir = (color == PieceColor::BLACK) ? 1 : -1;
-    }
+    int dir = (color == PieceColor::WHITE) ? 1 : -1;
     // --- 1. One-Square Forward Move ---
     Position oneAhead(from.x, from.y + dir);
     if (OwningBoard->isInside(oneAhead.x, oneAhead.y) &&
@@ -234,7 +518,7 @@ std::vector<Move> Pawn::getLegalMoves(const Position& from) const {
     for (int dx : {-1, 1}) {
         Position cap(from.x + dx, from.y + dir);
         if (OwningBoard->isInside(cap.x, cap.y)) {
-            Piece* target = OwningBoard->getPiece(cap.x, cap.y);
+            const Piece* target = OwningBoard->getPiece(cap.x, cap.y);
             if (target->getType() != PieceType::EMPTY && target->getColor() != color)
                 moves.emplace_back(from, cap, MoveType::CAPTURE);
         }
@@ -246,91 +530,34 @@ std::vector<Move> Pawn::getLegalMoves(const Position& from) const {
 // ---------------- Knight ----------------
 std::vector<Move> Knight::getLegalMoves(const Position& from) const {
     std::vector<Move> moves;
-    std::vector<std::pair<int, int>> offsets = {
-        {2, 1}, {1, 2}, {-1, 2}, {-2, 1},
-        {-2, -1}, {-1, -2}, {1, -2}, {2, -1}
-    };
-
-    for (auto [dx, dy] : offsets) {
-        Position to(from.x + dx, from.y + dy);
-        if (OwningBoard->isInside(to.x, to.y)) {
-            Piece* target = OwningBoard->getPiece(to.x, to.y);
-            if (target->getColor() != color)
-                moves.emplace_back(from, to, target->getColor() == PieceColor::NONE ? MoveType::NORMAL : MoveType::CAPTURE);
-        }
-    }
+    appendTargetMoves(*OwningBoard, from, color, knightAttacks(makeSquare(from.x, from.y)), moves);
     return moves;
 }
 
 // ---------------- Bishop ----------------
 std::vector<Move> Bishop::getLegalMoves(const Position& from) const {
     std::vector<Move> moves;
-    std::vector<std::pair<int, int>> dirs = { {1,1}, {1,-1}, {-1,1}, {-1,-1} };
-
-    for (auto [dx, dy] : dirs) {
-        int x = from.x + dx, y = from.y + dy;
-        while (OwningBoard->isInside(x, y)) {
-            Piece* target = OwningBoard->getPiece(x, y);
-            if (target->getType() == PieceType::EMPTY)
-                moves.emplace_back(from, Position(x, y));
-            else {
-                if (target->getColor() != color)
-                    moves.emplace_back(from, Position(x, y), MoveType::CAPTURE);
-                break;
-            }
-            x += dx; y += dy;
-        }
-    }
+    appendTargetMoves(*OwningBoard, from, color, bishopAttacks(makeSquare(from.x, from.y), OwningBoard->occupied), moves);
     return moves;
 }
 
 // ---------------- Rook ----------------
 std::vector<Move> Rook::getLegalMoves(const Position& from) const {
     std::vector<Move> moves;
-    std::vector<std::pair<int, int>> dirs = { {1,0}, {-1,0}, {0,1}, {0,-1} };
-
-    for (auto [dx, dy] : dirs) {
-        int x = from.x + dx, y = from.y + dy;
-        while (OwningBoard->isInside(x, y)) {
-            Piece* target = OwningBoard->getPiece(x, y);
-            if (target->getType() == PieceType::EMPTY)
-                moves.emplace_back(from, Position(x, y));
-            else {
-                if (target->getColor() != color)
-                    moves.emplace_back(from, Position(x, y), MoveType::CAPTURE);
-                break;
-            }
-            x += dx; y += dy;
-        }
-    }
+    appendTargetMoves(*OwningBoard, from, color, rookAttacks(makeSquare(from.x, from.y), OwningBoard->occupied), moves);
     return moves;
 }
 
 // ---------------- Queen ----------------
 std::vector<Move> Queen::getLegalMoves(const Position& from) const {
     std::vector<Move> moves;
-    Rook rook(color, OwningBoard);
-    Bishop bishop(color, OwningBoard);
-
-    auto rMoves = rook.getLegalMoves(from);
-    auto bMoves = bishop.getLegalMoves(from);
-    moves.insert(moves.end(), rMoves.begin(), rMoves.end());
-    moves.insert(moves.end(), bMoves.begin(), bMoves.end());
+    appendTargetMoves(*OwningBoard, from, color, queenAttacks(makeSquare(from.x, from.y), OwningBoard->occupied), moves);
     return moves;
 }
 
 // ---------------- King ----------------
 std::vector<Move> King::getLegalMoves(const Position& from) const {
     std::vector<Move> moves;
-    for (int dx = -1; dx <= 1; ++dx)
-        for (int dy = -1; dy <= 1; ++dy)
-            if (dx != 0 || dy != 0) {
-                Position to(from.x + dx, from.y + dy);
-                if (OwningBoard->isInside(to.x, to.y)) {
-                    Piece* target = OwningBoard->getPiece(to.x, to.y);
-                    if (target->getColor() != color)
-                        moves.emplace_back(from, to, target->getColor() == PieceColor::NONE ? MoveType::NORMAL : MoveType::CAPTURE);
-                }
-            }
+    appendTargetMoves(*OwningBoard, from, color, kingAttacks(makeSquare(from.x, from.y)), moves);
     return moves;
 }
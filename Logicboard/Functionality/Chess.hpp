@@ -2,8 +2,11 @@
 #include <vector>
 #include <array>
 #include <memory>
-#include "../Rendering/Renderer.hpp"
-#include "../Functionality/Misc.hpp"
+#include <cstdint>
+#include <string>
+#include "Bitboard.hpp"
+#include "Zobrist.hpp"
+#include "Psqt.hpp"
 namespace Chess {
     enum class PieceType { EMPTY = 0, PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING };
     enum class PieceColor { NONE = 0, WHITE, BLACK };
@@ -11,6 +14,24 @@ namespace Chess {
 	enum class GameState { ONGOING = 0, PAUSED, CHECK, CHECKMATE, STALEMATE };
 	class Board; // Forward declaration
 
+    // Mailbox encoding: 0 is an empty square, 1-6 white pawn..king, 7-12 black pawn..king
+    constexpr int PIECE_CODE_COUNT = 13;
+    constexpr uint8_t pieceCode(PieceColor c, PieceType t) {
+        return c == PieceColor::NONE ? 0 : static_cast<uint8_t>((c == PieceColor::BLACK ? 6 : 0) + static_cast<int>(t));
+    }
+    constexpr PieceType codeType(uint8_t code) {
+        return code == 0 ? PieceType::EMPTY : static_cast<PieceType>((code - 1) % 6 + 1);
+    }
+    constexpr PieceColor codeColor(uint8_t code) {
+        return code == 0 ? PieceColor::NONE : (code > 6 ? PieceColor::BLACK : PieceColor::WHITE);
+    }
+    constexpr int colorIndex(PieceColor c) { return c == PieceColor::BLACK ? 1 : 0; }
+    constexpr PieceColor opposite(PieceColor c) { return c == PieceColor::WHITE ? PieceColor::BLACK : PieceColor::WHITE; }
+
+    // Castling rights bitmask
+    constexpr uint8_t WHITE_OO = 1, WHITE_OOO = 2, BLACK_OO = 4, BLACK_OOO = 8;
+    constexpr uint8_t ALL_CASTLING = WHITE_OO | WHITE_OOO | BLACK_OO | BLACK_OOO;
+
     struct Position {
         int x;
         int y;
@@ -41,8 +62,97 @@ namespace Chess {
         }
     };
 
+    // Compact move for lists, tables and the wire: bits 0-5 from square, 6-11 to square,
+    // 12-15 flags (0 normal, 1 capture, 2 castle, 3 en passant, 4-7 promotion to knight..queen).
+    // The all-zero value never encodes a real move and doubles as "no move".
+    class PackedMove {
+    public:
+        constexpr PackedMove() = default;
+        constexpr PackedMove(int from, int to, MoveType type = MoveType::NORMAL, PieceType promotion = PieceType::EMPTY)
+            : data(static_cast<uint16_t>(from | (to << 6) | (flagFor(type, promotion) << 12))) {
+        }
+        explicit PackedMove(const Move& move)
+            : PackedMove(makeSquare(move.from.x, move.from.y), makeSquare(move.to.x, move.to.y), move.type, move.promotion) {
+        }
+
+        constexpr int from() const { return data & 0x3F; }
+        constexpr int to() const { return (data >> 6) & 0x3F; }
+        constexpr MoveType type() const {
+            switch (data >> 12) {
+            case 0: return MoveType::NORMAL;
+            case 1: return MoveType::CAPTURE;
+            case 2: return MoveType::CASTLE;
+            case 3: return MoveType::EN_PASSANT;
+            default: return MoveType::PROMOTION;
+            }
+        }
+        constexpr PieceType promotion() const {
+            int flag = data >> 12;
+            return flag >= PROMOTION_FLAG ? static_cast<PieceType>(flag - PROMOTION_FLAG + static_cast<int>(PieceType::KNIGHT)) : PieceType::EMPTY;
+        }
+        constexpr bool isNull() const { return data == 0; }
+        constexpr uint16_t raw() const { return data; }
+        static constexpr PackedMove fromRaw(uint16_t raw) { PackedMove m; m.data = raw; return m; }
+
+        Move toMove() const {
+            return Move(Position(fileOf(from()), rankOf(from())), Position(fileOf(to()), rankOf(to())), type(), promotion());
+        }
+
+        constexpr bool operator==(const PackedMove& other) const { return data == other.data; }
+        constexpr bool operator!=(const PackedMove& other) const { return data != other.data; }
+
+    private:
+        static constexpr int PROMOTION_FLAG = 4;
+        static constexpr int flagFor(MoveType type, PieceType promotion) {
+            switch (type) {
+            case MoveType::CAPTURE: return 1;
+            case MoveType::CASTLE: return 2;
+            case MoveType::EN_PASSANT: return 3;
+            case MoveType::PROMOTION: // anything outside knight..queen is taken as a queen
+                return promotion >= PieceType::KNIGHT && promotion <= PieceType::QUEEN
+                    ? PROMOTION_FLAG + static_cast<int>(promotion) - static_cast<int>(PieceType::KNIGHT) : PROMOTION_FLAG + 3;
+            default: return 0;
+            }
+        }
+
+        uint16_t data = 0;
+    };
+    static_assert(sizeof(PackedMove) == 2);
+
+    // Long algebraic notation as used by UCI, e.g. "e2e4" or "e7e8q"
+    std::string moveToUci(PackedMove move);
+    inline std::string moveToUci(const Move& move) { return moveToUci(PackedMove(move)); }
+
+    // Everything doMove overwrites that cannot be recomputed from the move itself
+    struct UndoInfo {
+        PackedMove move;
+        uint8_t captured;       // piece code, 0 if nothing was taken
+        uint8_t castlingRights;
+        int8_t epSquare;
+        uint8_t halfmoveClock;
+        uint64_t hash;
+    };
+
+    // Fixed-capacity move buffer meant to live on the caller's stack; no position has more than 218 moves
+    struct MoveList {
+        static constexpr int CAPACITY = 256;
+        std::array<PackedMove, CAPACITY> moves;
+        int count = 0;
+
+        void add(PackedMove move) { moves[count++] = move; }
+        int size() const { return count; }
+        bool empty() const { return count == 0; }
+        void clear() { count = 0; }
+        PackedMove operator[](int i) const { return moves[i]; }
+        PackedMove* begin() { return moves.data(); }
+        PackedMove* end() { return moves.data() + count; }
+        const PackedMove* begin() const { return moves.data(); }
+        const PackedMove* end() const { return moves.data() + count; }
+    };
+
+    // Sent as raw bytes over the network, so keep it trivially copyable and small
     struct GameInfo {
-        Chess::Move lastMove;
+        Chess::PackedMove lastMove;
         Chess::GameState gameState;
         Chess::PieceColor currentTurn;
     };
@@ -60,8 +170,6 @@ namespace Chess {
         virtual std::vector<Move> getLegalMoves(const Position& from) const = 0;
         PieceColor getColor() const { return color; }
         virtual PieceType getType() const = 0;
-		Renderer::VertexObject vertexObject;
-        bool isVisible = true;
     };
 
     // ------------------- Derived Pieces -------------------
@@ -115,27 +223,111 @@ namespace Chess {
     };
 
     // ------------------- Board -------------------
+    // Positions are absolute board coordinates: x is the file, y the rank, White starts on y = 0.
     class Board {
     public:
-        std::array<std::array<std::unique_ptr<Piece>, 8>, 8> grid;
-
         Board();
+        Board(const Board& other);
+        Board& operator=(const Board& other);
         ~Board() = default;
 
-
         bool isInside(int x, int y) const { return x >= 0 && x < 8 && y >= 0 && y < 8; }
-        Piece* getPiece(int x, int y) const { return grid[x][y].get(); }
-        void makeMove(Position from, Position to, std::vector<std::unique_ptr<Piece>>& takenPieces);
-        bool isSquareAttacked(Position pos, PieceColor attackerColor) const;
+        // Read-only view of a square. The returned object is shared by every square holding the same piece.
+        const Piece* getPiece(int x, int y) const { return pieceViews[mailbox[makeSquare(x, y)]].get(); }
+        bool makeMove(Position from, Position to, std::vector<const Piece*>& takenPieces);
+        void applyMove(PackedMove move, std::vector<const Piece*>& takenPieces);
+        // In-place make/unmake; undoMove reverts the most recent doMove
+        void doMove(PackedMove move);
+        void undoMove();
+        // Passes the turn for null-move pruning; the fifty-move counter restarts so that no
+        // repetition is ever found across the null move. Undone only by undoNullMove.
+        void doNullMove();
+        void undoNullMove();
+        // Zobrist key of the position, maintained incrementally by doMove/undoMove
+        uint64_t hash() const { return hashKey; }
+        uint64_t computeHash() const;
+        // Zobrist key of the pawns alone, for the pawn structure cache
+        uint64_t pawnHash() const { return pawnKey; }
+        uint64_t computePawnHash() const;
+        // Material and piece-square sums, kept in step by put/remove/movePiece; the compute
+        // versions rescan the board and exist to check the incremental ones
+        Score psqScore() const { return psq; }
+        int gamePhase() const { return phase; }
+        Score computePsq() const;
+        int computePhase() const;
+        // Pseudo-legal moves for the side to move (or the given side), no heap allocation
+        void generateMoves(MoveList& moves) const { generateMoves(moves, currentTurn); }
+        void generateMoves(MoveList& moves, PieceColor side) const;
+        // Strictly legal moves for the side to move, using pin and check masks computed once
+        void generateLegalMoves(MoveList& moves) const;
+        // The legal captures, en passant captures and promotions only
+        void generateLegalCaptures(MoveList& moves) const;
+        // Static exchange evaluation: material won (negative if lost) by the capture sequence the
+        // move starts on its target square, both sides always recapturing with their cheapest piece
+        int see(PackedMove move) const;
+        int see(const Move& move) const { return see(PackedMove(move)); }
+        // Attack queries work outward from the target square: leaper masks plus two slider lookups
+        Bitboard attackersTo(int sq, Bitboard occ) const;
+        Bitboard attackersTo(int sq) const { return attackersTo(sq, occupied); }
+        bool isSquareAttacked(int sq, PieceColor attackerColor) const {
+            return (attackersTo(sq) & colorBB[colorIndex(attackerColor)]) != 0;
+        }
+        bool isSquareAttacked(Position pos, PieceColor attackerColor) const {
+            return isSquareAttacked(makeSquare(pos.x, pos.y), attackerColor);
+        }
 		Position kingPosition(PieceColor kingColor) const;
+        int kingSquareOf(PieceColor kingColor) const { return kingSquare[colorIndex(kingColor)]; }
 		bool isChecked(PieceColor kingColor);
         void resetBoard();
+        // Sets up a position from Forsyth-Edwards Notation; returns false (board unchanged) if it does not parse
+        bool loadFen(const std::string& fen);
 		void updateGameState();
         void gameOver();
 
 		PieceColor currentTurn = PieceColor::WHITE;
 		GameState gameState = GameState::PAUSED;
-		Move lastMove;
+		PackedMove lastMove;
+
+        // Bitboard core, the real board state
+        std::array<Bitboard, PIECE_CODE_COUNT> pieceBB{}; // indexed by piece code, [0] stays empty
+        std::array<Bitboard, 2> colorBB{};                // indexed by colorIndex()
+        Bitboard occupied = 0;
+        std::array<uint8_t, 64> mailbox{};                // piece code per square
+        std::array<int, 2> kingSquare{ -1, -1 };          // kept in step by put/remove/movePiece
+        uint8_t castlingRights = ALL_CASTLING;
+        int epSquare = -1;                                // square a pawn can capture onto en passant
+        int halfmoveClock = 0;
+        std::vector<UndoInfo> history;
+        uint64_t hashKey = 0;
+        uint64_t pawnKey = 0;                             // kept in step by put/remove/movePiece
+        Score psq;                                        // White minus Black, see PSQT::table
+        int phase = 0;                                    // sum of PSQT::phaseWeight over all pieces
+
+        Bitboard pieces(PieceType t) const {
+            return pieceBB[pieceCode(PieceColor::WHITE, t)] | pieceBB[pieceCode(PieceColor::BLACK, t)];
+        }
+        Bitboard pieces(PieceColor c, PieceType t) const { return pieceBB[pieceCode(c, t)]; }
+
+        void putPiece(int sq, uint8_t code);
+        void removePiece(int sq);
+        void movePiece(int from, int to); // destination must be empty
+        void clear();
+
+    private:
+        std::array<std::unique_ptr<Piece>, PIECE_CODE_COUNT> pieceViews;
+        void createPieceViews();
+        void addCastlingMoves(MoveList& moves, PieceColor side) const;
+        template<bool CapturesOnly> void generateLegal(MoveList& moves) const;
+        bool enPassantLegal(int from, int to, PieceColor side) const;
     };
 
+    inline Bitboard Board::attackersTo(int sq, Bitboard occ) const {
+        return (pawnAttacks(colorIndex(PieceColor::WHITE), sq) & pieces(PieceColor::BLACK, PieceType::PAWN))
+            | (pawnAttacks(colorIndex(PieceColor::BLACK), sq) & pieces(PieceColor::WHITE, PieceType::PAWN))
+            | (knightAttacks(sq) & pieces(PieceType::KNIGHT))
+            | (kingAttacks(sq) & pieces(PieceType::KING))
+            | (bishopAttacks(sq, occ) & (pieces(PieceType::BISHOP) | pieces(PieceType::QUEEN)))
+            | (rookAttacks(sq, occ) & (pieces(PieceType::ROOK) | pieces(PieceType::QUEEN)));
+    }
+
 } // namespace Chess
\ No newline at end of file
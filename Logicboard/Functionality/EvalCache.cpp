@@ -0,0 +1,20 @@
+#include "EvalCache.hpp"
+
+namespace Chess {
+    EvalCache evalCache;
+
+    void EvalCache::resize(size_t megabytes) {
+        size_t count = 1;
+        while (count * 2 * sizeof(uint64_t) <= megabytes * 1024 * 1024)
+            count *= 2;
+        entries = std::make_unique<std::atomic<uint64_t>[]>(count);
+        mask = count - 1;
+        clear();
+    }
+
+    // An all-zero word only matches keys whose upper 48 bits are zero, which is close enough to never
+    void EvalCache::clear() {
+        for (size_t i = 0; i <= mask; ++i)
+            entries[i].store(0, std::memory_order_relaxed);
+    }
+} // namespace Chess
@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Chess {
+    // Shared cache of NNUE evaluations keyed by Board::hash(). Each entry is a single 64-bit
+    // word, the upper 48 key bits over the 16-bit score, so threads read and write it without
+    // locks and an entry can never be torn. Colliding positions simply overwrite each other.
+    class EvalCache {
+    public:
+        static constexpr size_t DEFAULT_MB = 1;
+
+        EvalCache() { resize(DEFAULT_MB); }
+        EvalCache(const EvalCache&) = delete;
+        EvalCache& operator=(const EvalCache&) = delete;
+
+        // Rounds down to a power-of-two number of entries. Not safe while a search is running.
+        void resize(size_t megabytes);
+        void clear();
+
+        bool probe(uint64_t key, int& score) const {
+            uint64_t data = entries[key & mask].load(std::memory_order_relaxed);
+            if ((data ^ key) & KEY_MASK)
+                return false;
+            score = static_cast<int16_t>(data);
+            return true;
+        }
+        void store(uint64_t key, int score) {
+            entries[key & mask].store((key & KEY_MASK) | static_cast<uint16_t>(score), std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr uint64_t KEY_MASK = ~uint64_t(0xFFFF);
+
+        std::unique_ptr<std::atomic<uint64_t>[]> entries;
+        size_t mask = 0;
+    };
+
+    // The one cache every search thread shares
+    extern EvalCache evalCache;
+} // namespace Chess
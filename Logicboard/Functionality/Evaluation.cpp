@@ -0,0 +1,35 @@
+#include "Evaluation.hpp"
+
+namespace Chess {
+    namespace {
+        // Endgame bonus by relative rank for a passed pawn whose path to promotion is empty
+        constexpr int freePasserBonus[8] = { 0, 0, 5, 10, 20, 35, 60, 0 };
+
+        // Passed pawns come from the pawn table; whether anything stands in their way does not
+        int freePassers(const Board& board, Bitboard passed, PieceColor color) {
+            int bonus = 0;
+            while (passed) {
+                int sq = popLsb(passed);
+                Bitboard path = color == PieceColor::WHITE ? (FILE_A_BB << sq) & ~squareBB(sq)
+                                                           : (FILE_H_BB >> (63 - sq)) & ~squareBB(sq);
+                if (!(path & board.occupied))
+                    bonus += freePasserBonus[color == PieceColor::WHITE ? rankOf(sq) : 7 - rankOf(sq)];
+            }
+            return bonus;
+        }
+    }
+
+    // Material and piece-square terms come ready-summed from the board and pawn structure from
+    // the pawn table; only the blend between the midgame and endgame halves is done here
+    int evaluate(const Board& board, PawnTable& pawns) {
+        Score total = board.psqScore();
+        PawnEntry& entry = pawns.probe(board);
+        total += entry.score;
+        total.mg += entry.kingShelter(board, PieceColor::WHITE) - entry.kingShelter(board, PieceColor::BLACK);
+        total.eg += freePassers(board, entry.passed[0], PieceColor::WHITE) - freePassers(board, entry.passed[1], PieceColor::BLACK);
+
+        int phase = board.gamePhase() < PSQT::MAX_PHASE ? board.gamePhase() : PSQT::MAX_PHASE;
+        int score = (total.mg * phase + total.eg * (PSQT::MAX_PHASE - phase)) / PSQT::MAX_PHASE;
+        return board.currentTurn == PieceColor::WHITE ? score : -score;
+    }
+} // namespace Chess
@@ -0,0 +1,13 @@
+#pragma once
+#include "Chess.hpp"
+#include "Pawns.hpp"
+
+namespace Chess {
+    // Centipawn value per PieceType for exchanges and move ordering, the king is never traded so it counts as 0
+    constexpr int pieceValues[7] = { 0, 100, 320, 330, 500, 900, 0 };
+
+    // Static score of the position in centipawns, from the side to move's point of view,
+    // tapered between its midgame and endgame halves by the material left. Pawn structure
+    // and king shelter come from the caller's pawn table.
+    int evaluate(const Board& board, PawnTable& pawns);
+} // namespace Chess
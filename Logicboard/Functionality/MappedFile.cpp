@@ -0,0 +1,61 @@
+#include "MappedFile.hpp"
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Chess {
+    bool MappedFile::open(const std::string& path, Access access) {
+        close();
+#if defined(_WIN32)
+        (void)access;
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size;
+        HANDLE mapping = GetFileSizeEx(file, &size) && size.QuadPart > 0
+            ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+        CloseHandle(file);
+        if (!mapping)
+            return false;
+        view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping); // the view keeps the mapping alive
+        if (!view)
+            return false;
+        bytes = static_cast<size_t>(size.QuadPart);
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        void* mapped = fstat(fd, &info) == 0 && info.st_size > 0
+            ? mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd); // the mapping keeps the file alive
+        if (mapped == MAP_FAILED)
+            return false;
+        bytes = static_cast<size_t>(info.st_size);
+        posix_madvise(mapped, bytes, access == Access::RANDOM ? POSIX_MADV_RANDOM : POSIX_MADV_SEQUENTIAL);
+        view = mapped;
+        return true;
+#endif
+    }
+
+    void MappedFile::close() {
+        if (!view)
+            return;
+#if defined(_WIN32)
+        UnmapViewOfFile(view);
+#else
+        munmap(const_cast<void*>(view), bytes);
+#endif
+        view = nullptr;
+        bytes = 0;
+    }
+} // namespace Chess
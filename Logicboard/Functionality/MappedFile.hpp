@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace Chess {
+    // Read-only memory map of a whole file. Opening costs no reading at all, pages are faulted
+    // in as they are touched and the OS shares them between every process mapping the file.
+    class MappedFile {
+    public:
+        // How the pages will be touched, passed on to the OS as a read-ahead hint where it takes one
+        enum class Access { SEQUENTIAL, RANDOM };
+
+        MappedFile() = default;
+        ~MappedFile() { close(); }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // False, with nothing mapped, if the file is missing or empty
+        bool open(const std::string& path, Access access = Access::SEQUENTIAL);
+        void close();
+        bool isOpen() const { return view != nullptr; }
+
+        const unsigned char* data() const { return static_cast<const unsigned char*>(view); }
+        size_t size() const { return bytes; }
+
+    private:
+        const void* view = nullptr;
+        size_t bytes = 0;
+    };
+} // namespace Chess
@@ -1,6 +1,6 @@
 #include "Misc.hpp"
 
-std::string retrievePath(Chess::Piece* piece) {
+std::string retrievePath(const Chess::Piece* piece) {
     std::string texturePath = "Rendering/Assets/";
     texturePath += (piece->getColor() == Chess::PieceColor::WHITE ? "w" : "b");
     switch (piece->getType()) {
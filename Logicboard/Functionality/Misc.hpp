@@ -13,7 +13,7 @@
 #include <shellapi.h>
 namespace Chess { class Piece; struct Position; }
 
-std::string retrievePath(Chess::Piece* piece);
+std::string retrievePath(const Chess::Piece* piece);
 Chess::Position screenToWorld(double mouseX, double mouseY, int windowWidth, int windowHeight, float tileSize, int GRID_SIZE);
 
 
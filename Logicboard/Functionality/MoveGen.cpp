@@ -0,0 +1,261 @@
+#include "Chess.hpp"
+using namespace Chess;
+
+namespace {
+    inline void addTargets(MoveList& moves, int from, Bitboard targets, Bitboard enemies) {
+        while (targets) {
+            int to = popLsb(targets);
+            moves.add(PackedMove(from, to, (enemies & squareBB(to)) ? MoveType::CAPTURE : MoveType::NORMAL));
+        }
+    }
+
+    // A pawn reaching the last rank expands into one move per promotion piece. The queen
+    // comes first so callers matching on from/to alone (the UI) promote to a queen.
+    inline void addPawnMove(MoveList& moves, int from, int to, MoveType type) {
+        if (squareBB(to) & (RANK_1_BB | RANK_8_BB)) {
+            for (PieceType promo : { PieceType::QUEEN, PieceType::ROOK, PieceType::BISHOP, PieceType::KNIGHT })
+                moves.add(PackedMove(from, to, MoveType::PROMOTION, promo));
+        }
+        else
+            moves.add(PackedMove(from, to, type));
+    }
+
+    // Pawn moves come as whole sets shifted by a fixed amount, so the origin is to - offset
+    inline void addPawnTargets(MoveList& moves, Bitboard targets, int offset, MoveType type) {
+        while (targets) {
+            int to = popLsb(targets);
+            addPawnMove(moves, to - offset, to, type);
+        }
+    }
+
+    // Per-position legality context: a move is legal when it lands inside the check
+    // mask and a pinned mover stays on the line through its king
+    struct LegalityMasks {
+        int kingSq;
+        Bitboard checkMask;
+        Bitboard pinned;
+
+        bool keepsPin(int from, int to) const {
+            return !(pinned & squareBB(from)) || (lineBB(kingSq, from) & squareBB(to));
+        }
+    };
+
+    inline void addLegalTargets(MoveList& moves, const LegalityMasks& masks, int from, Bitboard targets, Bitboard enemies) {
+        targets &= masks.checkMask;
+        if (masks.pinned & squareBB(from))
+            targets &= lineBB(masks.kingSq, from);
+        addTargets(moves, from, targets, enemies);
+    }
+
+    inline void addLegalPawnTargets(MoveList& moves, const LegalityMasks& masks, Bitboard targets, int offset, MoveType type) {
+        targets &= masks.checkMask;
+        while (targets) {
+            int to = popLsb(targets);
+            if (masks.keepsPin(to - offset, to))
+                addPawnMove(moves, to - offset, to, type);
+        }
+    }
+
+    struct CastlingPath {
+        uint8_t right;
+        int kingFrom, kingTo, rookFrom;
+        Bitboard empty;  // squares between king and rook
+        Bitboard safe;   // squares the king crosses or lands on
+    };
+
+    constexpr CastlingPath castlingPaths[2][2] = {
+        { { WHITE_OO, 4, 6, 7, 0x60ULL, 0x60ULL }, { WHITE_OOO, 4, 2, 0, 0x0EULL, 0x0CULL } },
+        { { BLACK_OO, 60, 62, 63, 0x60ULL << 56, 0x60ULL << 56 }, { BLACK_OOO, 60, 58, 56, 0x0EULL << 56, 0x0CULL << 56 } },
+    };
+}
+
+void Board::addCastlingMoves(MoveList& moves, PieceColor side) const {
+    int us = colorIndex(side);
+    if (!(castlingRights & (us == 0 ? (WHITE_OO | WHITE_OOO) : (BLACK_OO | BLACK_OOO))))
+        return;
+    Bitboard enemies = colorBB[us ^ 1];
+    for (const CastlingPath& path : castlingPaths[us]) {
+        // The rights alone are not trusted to place the pieces: castling must never move a rook that is not there
+        if (!(castlingRights & path.right) || (occupied & path.empty)
+            || kingSquareOf(side) != path.kingFrom || mailbox[path.rookFrom] != pieceCode(side, PieceType::ROOK))
+            continue;
+        bool safe = !(attackersTo(path.kingFrom) & enemies);
+        for (Bitboard b = path.safe; safe && b; )
+            safe = !(attackersTo(popLsb(b)) & enemies);
+        if (safe)
+            moves.add(PackedMove(path.kingFrom, path.kingTo, MoveType::CASTLE));
+    }
+}
+
+// Capturing en passant removes two pawns from the capturer's rank, which can expose the
+// king along it, so legality is settled by replaying slider attacks on the new occupancy
+bool Board::enPassantLegal(int from, int to, PieceColor side) const {
+    PieceColor them = opposite(side);
+    int capturedSq = makeSquare(fileOf(to), rankOf(from));
+    int kingSq = kingSquareOf(side);
+    Bitboard occ = (occupied ^ squareBB(from) ^ squareBB(capturedSq)) | squareBB(to);
+    return !(rookAttacks(kingSq, occ) & (pieces(them, PieceType::ROOK) | pieces(them, PieceType::QUEEN)))
+        && !(bishopAttacks(kingSq, occ) & (pieces(them, PieceType::BISHOP) | pieces(them, PieceType::QUEEN)));
+}
+
+void Board::generateMoves(MoveList& moves, PieceColor side) const {
+    int us = colorIndex(side);
+    Bitboard own = colorBB[us];
+    Bitboard enemies = colorBB[us ^ 1];
+    Bitboard empty = ~occupied;
+
+    // --- Pawns ---
+    Bitboard pawns = pieceBB[pieceCode(side, PieceType::PAWN)];
+    if (side == PieceColor::WHITE) {
+        Bitboard single = (pawns << 8) & empty;
+        addPawnTargets(moves, single, 8, MoveType::NORMAL);
+        addPawnTargets(moves, ((single & RANK_3_BB) << 8) & empty, 16, MoveType::NORMAL);
+        addPawnTargets(moves, ((pawns & ~FILE_A_BB) << 7) & enemies, 7, MoveType::CAPTURE);
+        addPawnTargets(moves, ((pawns & ~FILE_H_BB) << 9) & enemies, 9, MoveType::CAPTURE);
+    }
+    else {
+        Bitboard single = (pawns >> 8) & empty;
+        addPawnTargets(moves, single, -8, MoveType::NORMAL);
+        addPawnTargets(moves, ((single & RANK_6_BB) >> 8) & empty, -16, MoveType::NORMAL);
+        addPawnTargets(moves, ((pawns & ~FILE_A_BB) >> 9) & enemies, -9, MoveType::CAPTURE);
+        addPawnTargets(moves, ((pawns & ~FILE_H_BB) >> 7) & enemies, -7, MoveType::CAPTURE);
+    }
+    if (epSquare >= 0 && side == currentTurn) {
+        Bitboard capturers = pawnAttacks(us ^ 1, epSquare) & pawns;
+        while (capturers)
+            moves.add(PackedMove(popLsb(capturers), epSquare, MoveType::EN_PASSANT));
+    }
+
+    // --- Pieces ---
+    Bitboard knights = pieceBB[pieceCode(side, PieceType::KNIGHT)];
+    while (knights) {
+        int from = popLsb(knights);
+        addTargets(moves, from, knightAttacks(from) & ~own, enemies);
+    }
+    Bitboard bishops = pieceBB[pieceCode(side, PieceType::BISHOP)];
+    while (bishops) {
+        int from = popLsb(bishops);
+        addTargets(moves, from, bishopAttacks(from, occupied) & ~own, enemies);
+    }
+    Bitboard rooks = pieceBB[pieceCode(side, PieceType::ROOK)];
+    while (rooks) {
+        int from = popLsb(rooks);
+        addTargets(moves, from, rookAttacks(from, occupied) & ~own, enemies);
+    }
+    Bitboard queens = pieceBB[pieceCode(side, PieceType::QUEEN)];
+    while (queens) {
+        int from = popLsb(queens);
+        addTargets(moves, from, queenAttacks(from, occupied) & ~own, enemies);
+    }
+    Bitboard kings = pieceBB[pieceCode(side, PieceType::KING)];
+    while (kings) {
+        int from = popLsb(kings);
+        addTargets(moves, from, kingAttacks(from) & ~own, enemies);
+    }
+    addCastlingMoves(moves, side);
+}
+
+// CapturesOnly keeps captures, en passant and promotions: the quiescence search's move set
+template<bool CapturesOnly>
+void Board::generateLegal(MoveList& moves) const {
+    PieceColor side = currentTurn;
+    int us = colorIndex(side);
+    Bitboard own = colorBB[us];
+    Bitboard enemies = colorBB[us ^ 1];
+    Bitboard empty = ~occupied;
+    Bitboard targets = CapturesOnly ? enemies : ~own;
+    Bitboard pushTargets = CapturesOnly ? (RANK_1_BB | RANK_8_BB) : ~Bitboard(0);
+    int kingSq = kingSquareOf(side);
+    Bitboard checkers = attackersTo(kingSq, occupied) & enemies;
+
+    // --- King --- (tested with the king lifted so it cannot hide behind itself on a slider ray)
+    Bitboard withoutKing = occupied ^ squareBB(kingSq);
+    Bitboard kingTargets = kingAttacks(kingSq) & targets;
+    while (kingTargets) {
+        int to = popLsb(kingTargets);
+        if (!(attackersTo(to, withoutKing) & enemies))
+            moves.add(PackedMove(kingSq, to, (enemies & squareBB(to)) ? MoveType::CAPTURE : MoveType::NORMAL));
+    }
+
+    // Double check: only the king may move
+    if (checkers & (checkers - 1))
+        return;
+
+    LegalityMasks masks;
+    masks.kingSq = kingSq;
+    masks.checkMask = checkers ? (betweenBB(kingSq, lsb(checkers)) | checkers) : ~Bitboard(0);
+    masks.pinned = 0;
+
+    // Enemy sliders lined up with our king pin the single piece of ours between them
+    PieceColor them = opposite(side);
+    Bitboard snipers = ((rookAttacks(kingSq, 0) & (pieces(them, PieceType::ROOK) | pieces(them, PieceType::QUEEN)))
+        | (bishopAttacks(kingSq, 0) & (pieces(them, PieceType::BISHOP) | pieces(them, PieceType::QUEEN))));
+    while (snipers) {
+        Bitboard blockers = betweenBB(kingSq, popLsb(snipers)) & occupied;
+        if (blockers && !(blockers & (blockers - 1)) && (blockers & own))
+            masks.pinned |= blockers;
+    }
+
+    // --- Pawns ---
+    Bitboard pawns = pieceBB[pieceCode(side, PieceType::PAWN)];
+    if (side == PieceColor::WHITE) {
+        Bitboard single = (pawns << 8) & empty;
+        addLegalPawnTargets(moves, masks, single & pushTargets, 8, MoveType::NORMAL);
+        if (!CapturesOnly)
+            addLegalPawnTargets(moves, masks, ((single & RANK_3_BB) << 8) & empty, 16, MoveType::NORMAL);
+        addLegalPawnTargets(moves, masks, ((pawns & ~FILE_A_BB) << 7) & enemies, 7, MoveType::CAPTURE);
+        addLegalPawnTargets(moves, masks, ((pawns & ~FILE_H_BB) << 9) & enemies, 9, MoveType::CAPTURE);
+    }
+    else {
+        Bitboard single = (pawns >> 8) & empty;
+        addLegalPawnTargets(moves, masks, single & pushTargets, -8, MoveType::NORMAL);
+        if (!CapturesOnly)
+            addLegalPawnTargets(moves, masks, ((single & RANK_6_BB) >> 8) & empty, -16, MoveType::NORMAL);
+        addLegalPawnTargets(moves, masks, ((pawns & ~FILE_A_BB) >> 9) & enemies, -9, MoveType::CAPTURE);
+        addLegalPawnTargets(moves, masks, ((pawns & ~FILE_H_BB) >> 7) & enemies, -7, MoveType::CAPTURE);
+    }
+    if (epSquare >= 0) {
+        // Either the landing square or the captured pawn has to resolve a check
+        int capturedSq = epSquare + (side == PieceColor::WHITE ? -8 : 8);
+        if (masks.checkMask & (squareBB(epSquare) | squareBB(capturedSq))) {
+            Bitboard capturers = pawnAttacks(us ^ 1, epSquare) & pawns;
+            while (capturers) {
+                int from = popLsb(capturers);
+                if (enPassantLegal(from, epSquare, side))
+                    moves.add(PackedMove(from, epSquare, MoveType::EN_PASSANT));
+            }
+        }
+    }
+    if (!CapturesOnly && !checkers)
+        addCastlingMoves(moves, side);
+
+    // --- Pieces --- (a pinned knight can never stay on its pin line)
+    Bitboard knights = pieceBB[pieceCode(side, PieceType::KNIGHT)] & ~masks.pinned;
+    while (knights) {
+        int from = popLsb(knights);
+        addLegalTargets(moves, masks, from, knightAttacks(from) & targets, enemies);
+    }
+    Bitboard bishops = pieceBB[pieceCode(side, PieceType::BISHOP)];
+    while (bishops) {
+        int from = popLsb(bishops);
+        addLegalTargets(moves, masks, from, bishopAttacks(from, occupied) & targets, enemies);
+    }
+    Bitboard rooks = pieceBB[pieceCode(side, PieceType::ROOK)];
+    while (rooks) {
+        int from = popLsb(rooks);
+        addLegalTargets(moves, masks, from, rookAttacks(from, occupied) & targets, enemies);
+    }
+    Bitboard queens = pieceBB[pieceCode(side, PieceType::QUEEN)];
+    while (queens) {
+        int from = popLsb(queens);
+        addLegalTargets(moves, masks, from, queenAttacks(from, occupied) & targets, enemies);
+    }
+}
+
+void Board::generateLegalMoves(MoveList& moves) const {
+    generateLegal<false>(moves);
+}
+
+void Board::generateLegalCaptures(MoveList& moves) const {
+    generateLegal<true>(moves);
+}
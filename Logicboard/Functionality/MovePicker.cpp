@@ -0,0 +1,189 @@
+#include "MovePicker.hpp"
+#include "Evaluation.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+namespace Chess {
+    void OrderingTables::clear() {
+        for (auto& slot : killers)
+            slot[0] = slot[1] = PackedMove();
+        for (auto& side : history)
+            for (auto& from : side)
+                std::fill(std::begin(from), std::end(from), int16_t(0));
+        for (auto& piece : counterMoves)
+            std::fill(std::begin(piece), std::end(piece), PackedMove());
+    }
+
+    void OrderingTables::age() {
+        for (auto& slot : killers)
+            slot[0] = slot[1] = PackedMove();
+        for (auto& side : history)
+            for (auto& from : side)
+                for (int16_t& entry : from)
+                    entry /= 2;
+    }
+
+    PackedMove OrderingTables::counterMove(const Board& board) const {
+        if (board.history.empty())
+            return PackedMove();
+        PackedMove previous = board.history.back().move;
+        if (previous.isNull())
+            return PackedMove();
+        return counterMoves[board.mailbox[previous.to()]][previous.to()];
+    }
+
+    void OrderingTables::updateQuiet(const Board& board, int ply, int depth, PackedMove best, const PackedMove* tried, int triedCount) {
+        if (killers[ply][0] != best) {
+            killers[ply][1] = killers[ply][0];
+            killers[ply][0] = best;
+        }
+
+        // Gravity update: entries saturate towards +-MAX_HISTORY instead of overflowing
+        int bonus = std::min(32 * depth * depth, MAX_HISTORY / 8);
+        auto update = [](int16_t& entry, int delta) {
+            entry += static_cast<int16_t>(delta - entry * std::abs(delta) / MAX_HISTORY);
+        };
+        auto& side = history[colorIndex(board.currentTurn)];
+        update(side[best.from()][best.to()], bonus);
+        for (int i = 0; i < triedCount; ++i) {
+            if (tried[i] != best)
+                update(side[tried[i].from()][tried[i].to()], -bonus);
+        }
+
+        if (!board.history.empty() && !board.history.back().move.isNull()) {
+            PackedMove previous = board.history.back().move;
+            counterMoves[board.mailbox[previous.to()]][previous.to()] = best;
+        }
+    }
+
+    MovePicker::MovePicker(const Board& board, MoveList& moves, PackedMove ttMove, const OrderingTables& tables, int ply)
+        : board(board), moves(moves), tables(&tables), ttMove(ttMove), quiescence(false) {
+        refutations[0] = tables.killers[ply][0];
+        refutations[1] = tables.killers[ply][1];
+        refutations[2] = tables.counterMove(board);
+        if (refutations[2] == refutations[0] || refutations[2] == refutations[1])
+            refutations[2] = PackedMove();
+        // A hash move from another position with the same key is not in the list and is ignored
+        if (ttMove.isNull() || !contains(0, moves.size(), ttMove))
+            this->ttMove = PackedMove();
+        stage = this->ttMove.isNull() ? Stage::INIT_CAPTURES : Stage::TT_MOVE;
+    }
+
+    MovePicker::MovePicker(const Board& board, MoveList& moves)
+        : board(board), moves(moves), tables(nullptr), stage(Stage::INIT_CAPTURES), quiescence(true) {
+    }
+
+    bool MovePicker::isRefutation(PackedMove move) const {
+        return move == refutations[0] || move == refutations[1] || move == refutations[2];
+    }
+
+    bool MovePicker::contains(int first, int last, PackedMove move) const {
+        for (int i = first; i < last; ++i) {
+            if (moves.moves[i] == move)
+                return true;
+        }
+        return false;
+    }
+
+    // Most valuable victim first, cheapest attacker breaking ties; a queen promotion adds its gain
+    void MovePicker::scoreCaptures() {
+        for (int i = 0; i < captureEnd; ++i) {
+            PackedMove move = moves.moves[i];
+            uint8_t victim = move.type() == MoveType::EN_PASSANT ? pieceCode(PieceColor::WHITE, PieceType::PAWN) : board.mailbox[move.to()];
+            int score = pieceValues[static_cast<int>(codeType(victim))] * 8 - static_cast<int>(codeType(board.mailbox[move.from()]));
+            if (move.type() == MoveType::PROMOTION)
+                score += pieceValues[static_cast<int>(move.promotion())] * 8;
+            scores[i] = score;
+        }
+    }
+
+    void MovePicker::scoreQuiets() {
+        const auto& side = tables->history[colorIndex(board.currentTurn)];
+        for (int i = captureEnd; i < moves.size(); ++i)
+            scores[i] = side[moves.moves[i].from()][moves.moves[i].to()];
+    }
+
+    // One selection-sort step over [current, last): only as much of the list is sorted as is used
+    PackedMove MovePicker::pickBest(int last) {
+        int best = current;
+        for (int i = current + 1; i < last; ++i) {
+            if (scores[i] > scores[best])
+                best = i;
+        }
+        std::swap(moves.moves[current], moves.moves[best]);
+        std::swap(scores[current], scores[best]);
+        return moves.moves[current++];
+    }
+
+    PackedMove MovePicker::next() {
+        switch (stage) {
+        case Stage::TT_MOVE:
+            stage = Stage::INIT_CAPTURES;
+            return ttMove;
+
+        case Stage::INIT_CAPTURES: {
+            // Captures to the front, quiets behind them
+            PackedMove* split = std::partition(moves.begin(), moves.end(), [this](PackedMove move) { return !isQuiet(board, move); });
+            captureEnd = static_cast<int>(split - moves.begin());
+            scoreCaptures();
+            current = 0;
+            stage = Stage::GOOD_CAPTURES;
+            [[fallthrough]];
+        }
+        case Stage::GOOD_CAPTURES:
+            while (current < captureEnd) {
+                PackedMove move = pickBest(captureEnd);
+                if (move == ttMove)
+                    continue;
+                if (board.see(move) < 0) {
+                    if (!quiescence)
+                        std::swap(moves.moves[badCount++], moves.moves[current - 1]);
+                    continue;
+                }
+                return move;
+            }
+            if (quiescence) {
+                stage = Stage::DONE;
+                return PackedMove();
+            }
+            stage = Stage::REFUTATIONS;
+            [[fallthrough]];
+
+        case Stage::REFUTATIONS:
+            while (refutation < 3) {
+                PackedMove move = refutations[refutation++];
+                if (!move.isNull() && move != ttMove && isQuiet(board, move) && contains(captureEnd, moves.size(), move))
+                    return move;
+            }
+            stage = Stage::INIT_QUIETS;
+            [[fallthrough]];
+
+        case Stage::INIT_QUIETS:
+            scoreQuiets();
+            current = captureEnd;
+            stage = Stage::QUIETS;
+            [[fallthrough]];
+
+        case Stage::QUIETS:
+            while (current < moves.size()) {
+                PackedMove move = pickBest(moves.size());
+                if (move != ttMove && !isRefutation(move))
+                    return move;
+            }
+            current = 0;
+            stage = Stage::BAD_CAPTURES;
+            [[fallthrough]];
+
+        case Stage::BAD_CAPTURES:
+            if (current < badCount)
+                return moves.moves[current++];
+            stage = Stage::DONE;
+            [[fallthrough]];
+
+        case Stage::DONE:
+            break;
+        }
+        return PackedMove();
+    }
+} // namespace Chess
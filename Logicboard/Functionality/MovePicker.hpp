@@ -0,0 +1,70 @@
+#pragma once
+#include "Chess.hpp"
+#include "Search.hpp"
+#include <cstdint>
+
+namespace Chess {
+    // What the search has learned about quiet moves, kept per search thread so it is never
+    // shared: two killers per ply, a butterfly history and a countermove per previous move
+    struct OrderingTables {
+        static constexpr int MAX_HISTORY = 16384;
+
+        PackedMove killers[MAX_PLY][2];
+        int16_t history[2][64][64];          // [colorIndex][from][to]
+        PackedMove counterMoves[13][64];     // [piece code][to] of the move being answered
+
+        OrderingTables() { clear(); }
+        void clear();
+        // Between searches: killers belong to the old position, history only loses weight
+        void age();
+
+        // Reply to the opponent's last move, null at the root of a fresh game or after a null move
+        PackedMove counterMove(const Board& board) const;
+        // After a quiet move caused a beta cutoff: reward it and penalise the quiets tried before it
+        void updateQuiet(const Board& board, int ply, int depth, PackedMove best, const PackedMove* tried, int triedCount);
+    };
+
+    // Hands out the legal moves one at a time in stages, so the work of ordering the rest is
+    // skipped whenever an early move cuts off: the hash move, captures winning or trading
+    // material by MVV-LVA, killers, the countermove, quiets by history, then losing captures.
+    class MovePicker {
+    public:
+        // Main search: every move in the list
+        MovePicker(const Board& board, MoveList& moves, PackedMove ttMove, const OrderingTables& tables, int ply);
+        // Quiescence: captures (underpromoting ones included) and queen promotions only, losing captures dropped
+        MovePicker(const Board& board, MoveList& moves);
+
+        // Null once every move has been handed out
+        PackedMove next();
+
+        // Asked before the move is made. A promotion flag does not say whether the pawn also
+        // captures, so the target square does: capturing underpromotions stay captures.
+        static bool isQuiet(const Board& board, PackedMove move) {
+            MoveType type = move.type();
+            return type == MoveType::NORMAL || type == MoveType::CASTLE
+                || (type == MoveType::PROMOTION && move.promotion() != PieceType::QUEEN && board.mailbox[move.to()] == 0);
+        }
+
+    private:
+        enum class Stage { TT_MOVE, INIT_CAPTURES, GOOD_CAPTURES, REFUTATIONS, INIT_QUIETS, QUIETS, BAD_CAPTURES, DONE };
+
+        const Board& board;
+        MoveList& moves;
+        const OrderingTables* tables;
+        PackedMove ttMove;
+        PackedMove refutations[3];  // both killers and the countermove, tried before other quiets
+        int scores[MoveList::CAPACITY];
+        Stage stage;
+        int current = 0;
+        int captureEnd = 0; // captures sit in [0, captureEnd), quiets after them
+        int badCount = 0;   // losing captures are parked at the front of the list
+        int refutation = 0;
+        bool quiescence;
+
+        bool isRefutation(PackedMove move) const;
+        bool contains(int first, int last, PackedMove move) const;
+        void scoreCaptures();
+        void scoreQuiets();
+        PackedMove pickBest(int last);
+    };
+} // namespace Chess
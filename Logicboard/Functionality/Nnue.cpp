@@ -0,0 +1,346 @@
+#include "Nnue.hpp"
+#include "EvalCache.hpp"
+#include "MappedFile.hpp"
+#include "Search.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NNUE_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define NNUE_TARGET(isa)
+#else
+#define NNUE_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace Chess::NNUE {
+    namespace {
+        // Points straight into the mapped file, which must stay mapped while the network is in use
+        struct Network {
+            const int16_t* featureWeights = nullptr;
+            const int16_t* featureBiases = nullptr;
+            const int16_t* outputWeights = nullptr;
+            int32_t outputBias = 0;
+        };
+        MappedFile file;
+        Network network;
+
+        constexpr size_t FILE_BYTES = HEADER_BYTES + sizeof(int16_t) * (static_cast<size_t>(INPUTS) * HIDDEN + HIDDEN + 2 * HIDDEN) + sizeof(int32_t);
+
+        uint32_t readU32(const unsigned char* p) {
+            return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+
+        // ---------------- Kernels ----------------
+        // out = in + the added weight columns - the removed ones, over the whole hidden layer
+
+        void updateScalar(int16_t* out, const int16_t* in, const int16_t* const* adds, int addCount, const int16_t* const* subs, int subCount) {
+            for (int i = 0; i < HIDDEN; ++i) {
+                int value = in[i];
+                for (int a = 0; a < addCount; ++a)
+                    value += adds[a][i];
+                for (int s = 0; s < subCount; ++s)
+                    value -= subs[s][i];
+                out[i] = static_cast<int16_t>(value);
+            }
+        }
+
+        // Clipped ReLU of both perspectives dotted with the output weights
+        int32_t outputScalar(const int16_t* us, const int16_t* them, const int16_t* weights) {
+            int32_t sum = 0;
+            for (int i = 0; i < HIDDEN; ++i) {
+                int x = us[i] < 0 ? 0 : us[i] > QA ? QA : us[i];
+                int y = them[i] < 0 ? 0 : them[i] > QA ? QA : them[i];
+                sum += x * weights[i] + y * weights[HIDDEN + i];
+            }
+            return sum;
+        }
+
+#ifdef NNUE_X86
+        NNUE_TARGET("sse4.1")
+        void updateSse41(int16_t* out, const int16_t* in, const int16_t* const* adds, int addCount, const int16_t* const* subs, int subCount) {
+            for (int i = 0; i < HIDDEN; i += 8) {
+                __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                for (int a = 0; a < addCount; ++a)
+                    value = _mm_add_epi16(value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(adds[a] + i)));
+                for (int s = 0; s < subCount; ++s)
+                    value = _mm_sub_epi16(value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(subs[s] + i)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), value);
+            }
+        }
+
+        NNUE_TARGET("sse4.1")
+        int32_t outputSse41(const int16_t* us, const int16_t* them, const int16_t* weights) {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i ceiling = _mm_set1_epi16(QA);
+            __m128i sum = _mm_setzero_si128();
+            for (int i = 0; i < HIDDEN; i += 8) {
+                __m128i x = _mm_min_epi16(_mm_max_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(us + i)), zero), ceiling);
+                __m128i y = _mm_min_epi16(_mm_max_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(them + i)), zero), ceiling);
+                sum = _mm_add_epi32(sum, _mm_madd_epi16(x, _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i))));
+                sum = _mm_add_epi32(sum, _mm_madd_epi16(y, _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + HIDDEN + i))));
+            }
+            sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+            sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+            return _mm_cvtsi128_si32(sum);
+        }
+
+        NNUE_TARGET("avx2")
+        void updateAvx2(int16_t* out, const int16_t* in, const int16_t* const* adds, int addCount, const int16_t* const* subs, int subCount) {
+            for (int i = 0; i < HIDDEN; i += 16) {
+                __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+                for (int a = 0; a < addCount; ++a)
+                    value = _mm256_add_epi16(value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(adds[a] + i)));
+                for (int s = 0; s < subCount; ++s)
+                    value = _mm256_sub_epi16(value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(subs[s] + i)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), value);
+            }
+        }
+
+        NNUE_TARGET("avx2")
+        int32_t outputAvx2(const int16_t* us, const int16_t* them, const int16_t* weights) {
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i ceiling = _mm256_set1_epi16(QA);
+            __m256i sum = _mm256_setzero_si256();
+            for (int i = 0; i < HIDDEN; i += 16) {
+                __m256i x = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(us + i)), zero), ceiling);
+                __m256i y = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(them + i)), zero), ceiling);
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(x, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i))));
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(y, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + HIDDEN + i))));
+            }
+            __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+            half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+            half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+            return _mm_cvtsi128_si32(half);
+        }
+#endif
+
+        Simd detect() {
+#ifdef NNUE_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 0);
+            int maxLeaf = info[0];
+            __cpuid(info, 1);
+            bool sse41 = (info[2] & (1 << 19)) != 0;
+            // AVX registers are only usable if the OS saves them (OSXSAVE, then XCR0 bits 1 and 2)
+            bool osAvx = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+            bool avx2 = false;
+            if (maxLeaf >= 7 && osAvx) {
+                __cpuidex(info, 7, 0);
+                avx2 = (info[1] & (1 << 5)) != 0;
+            }
+#else
+            __builtin_cpu_init();
+            bool sse41 = __builtin_cpu_supports("sse4.1");
+            bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+            return avx2 ? Simd::AVX2 : sse41 ? Simd::SSE41 : Simd::SCALAR;
+#else
+            return Simd::SCALAR;
+#endif
+        }
+
+        struct Kernels {
+            void (*update)(int16_t*, const int16_t*, const int16_t* const*, int, const int16_t* const*, int);
+            int32_t (*output)(const int16_t*, const int16_t*, const int16_t*);
+        };
+
+        Kernels kernelsFor(Simd simd) {
+#ifdef NNUE_X86
+            if (simd == Simd::AVX2)
+                return { updateAvx2, outputAvx2 };
+            if (simd == Simd::SSE41)
+                return { updateSse41, outputSse41 };
+#endif
+            return { updateScalar, outputScalar };
+        }
+
+        const Simd detectedLevel = detect();
+        Simd activeLevel = detectedLevel;
+        Kernels kernels = kernelsFor(detectedLevel);
+
+        // ---------------- Features ----------------
+
+        inline int featureIndex(int perspective, int kingSq, uint8_t code, int sq) {
+            if (perspective == 1) {
+                kingSq ^= 56;
+                sq ^= 56;
+            }
+            int kind = static_cast<int>(codeType(code)) - 1 + (colorIndex(codeColor(code)) == perspective ? 0 : 5);
+            return (kingSq * PIECE_KINDS + kind) * 64 + sq;
+        }
+
+        inline const int16_t* column(int feature) {
+            return network.featureWeights + static_cast<size_t>(feature) * HIDDEN;
+        }
+
+        // Whether the move moved this perspective's own king, which changes every one of its features
+        bool movesKing(const DirtyPieces& dirty, int perspective) {
+            for (int i = 0; i < dirty.count; ++i) {
+                if (codeType(dirty.code[i]) == PieceType::KING && colorIndex(codeColor(dirty.code[i])) == perspective)
+                    return true;
+            }
+            return false;
+        }
+    }
+
+    bool load(const std::string& path) {
+        unload();
+        if (!file.open(path))
+            return false;
+        const unsigned char* data = file.data();
+        if (file.size() != FILE_BYTES || std::memcmp(data, "LBNN", 4) != 0 || readU32(data + 4) != FILE_VERSION
+            || readU32(data + 8) != static_cast<uint32_t>(INPUTS) || readU32(data + 12) != static_cast<uint32_t>(HIDDEN)) {
+            file.close();
+            return false;
+        }
+
+        // The header keeps every array 64-byte aligned within the page-aligned mapping
+        const int16_t* weights = reinterpret_cast<const int16_t*>(data + HEADER_BYTES);
+        network.featureWeights = weights;
+        network.featureBiases = weights + static_cast<size_t>(INPUTS) * HIDDEN;
+        network.outputWeights = network.featureBiases + HIDDEN;
+        std::memcpy(&network.outputBias, network.outputWeights + 2 * HIDDEN, sizeof(int32_t));
+        return true;
+    }
+
+    void unload() {
+        file.close();
+        network = Network();
+        // Cached scores belong to the network that produced them
+        evalCache.clear();
+    }
+
+    bool isLoaded() {
+        return file.isOpen();
+    }
+
+    Simd detectedSimd() {
+        return detectedLevel;
+    }
+
+    Simd activeSimd() {
+        return activeLevel;
+    }
+
+    void setSimd(Simd simd) {
+        activeLevel = simd > detectedLevel ? detectedLevel : simd;
+        kernels = kernelsFor(activeLevel);
+    }
+
+    const char* simdName(Simd simd) {
+        switch (simd) {
+        case Simd::AVX2: return "avx2";
+        case Simd::SSE41: return "sse4.1";
+        default: return "scalar";
+        }
+    }
+
+    DirtyPieces dirtyPieces(const Board& board, PackedMove move) {
+        DirtyPieces dirty;
+        int from = move.from();
+        int to = move.to();
+        MoveType type = move.type();
+        uint8_t code = board.mailbox[from];
+        auto add = [&dirty](uint8_t piece, int pieceFrom, int pieceTo) {
+            dirty.code[dirty.count] = piece;
+            dirty.from[dirty.count] = static_cast<int8_t>(pieceFrom);
+            dirty.to[dirty.count] = static_cast<int8_t>(pieceTo);
+            ++dirty.count;
+        };
+
+        int captureSq = type == MoveType::EN_PASSANT ? makeSquare(fileOf(to), rankOf(from)) : to;
+        if (board.mailbox[captureSq] != 0 && type != MoveType::CASTLE)
+            add(board.mailbox[captureSq], captureSq, -1);
+
+        if (type == MoveType::PROMOTION) {
+            add(code, from, -1);
+            add(pieceCode(codeColor(code), move.promotion()), -1, to);
+        }
+        else {
+            add(code, from, to);
+        }
+        if (type == MoveType::CASTLE) {
+            // Same rook squares as Board::doMove for a king landing on the g- or c-file
+            bool kingSide = fileOf(to) == 6;
+            int rookFrom = to + (kingSide ? 1 : -2);
+            add(board.mailbox[rookFrom], rookFrom, to + (kingSide ? -1 : 1));
+        }
+        return dirty;
+    }
+
+    void refresh(const Board& board, Accumulator& acc, PieceColor perspective) {
+        int p = colorIndex(perspective);
+        int kingSq = board.kingSquareOf(perspective);
+        const int16_t* adds[32];
+        int addCount = 0;
+        Bitboard pieces = board.occupied & ~board.pieces(PieceType::KING);
+        while (pieces) {
+            int sq = popLsb(pieces);
+            adds[addCount++] = column(featureIndex(p, kingSq, board.mailbox[sq], sq));
+        }
+        kernels.update(acc.values[p], network.featureBiases, adds, addCount, nullptr, 0);
+    }
+
+    int evaluate(const Board& board, const Accumulator& acc) {
+        int us = colorIndex(board.currentTurn);
+        int32_t output = kernels.output(acc.values[us], acc.values[us ^ 1], network.outputWeights) + network.outputBias;
+        // Whatever the network says must stay a static score: below the mate range, and within
+        // the int16 the transposition table and eval cache store it in
+        constexpr int64_t LIMIT = SCORE_MATE - MAX_PLY - 1;
+        return static_cast<int>(std::clamp<int64_t>(static_cast<int64_t>(output) * OUTPUT_SCALE / (QA * QB), -LIMIT, LIMIT));
+    }
+
+    void AccumulatorStack::reset(const Board& board) {
+        top = 0;
+        Entry& root = entries[0];
+        refresh(board, root.acc, PieceColor::WHITE);
+        refresh(board, root.acc, PieceColor::BLACK);
+        root.computed[0] = root.computed[1] = true;
+    }
+
+    const Accumulator& AccumulatorStack::current(const Board& board) {
+        for (PieceColor perspective : { PieceColor::WHITE, PieceColor::BLACK }) {
+            if (!entries[top].computed[colorIndex(perspective)])
+                update(perspective, board);
+        }
+        return entries[top].acc;
+    }
+
+    void AccumulatorStack::update(PieceColor perspective, const Board& board) {
+        int p = colorIndex(perspective);
+        // Walk back to the last computed ply, giving up at a move of our own king
+        int base = top;
+        while (!entries[base].computed[p]) {
+            if (movesKing(entries[base].dirty, p)) {
+                refresh(board, entries[top].acc, perspective);
+                entries[top].computed[p] = true;
+                return;
+            }
+            --base;
+        }
+
+        // Our king has not moved since, so the current king square holds for every ply on the way
+        int kingSq = board.kingSquareOf(perspective);
+        for (int ply = base + 1; ply <= top; ++ply) {
+            const DirtyPieces& dirty = entries[ply].dirty;
+            const int16_t* adds[3];
+            const int16_t* subs[3];
+            int addCount = 0, subCount = 0;
+            for (int i = 0; i < dirty.count; ++i) {
+                if (codeType(dirty.code[i]) == PieceType::KING)
+                    continue;
+                if (dirty.from[i] >= 0)
+                    subs[subCount++] = column(featureIndex(p, kingSq, dirty.code[i], dirty.from[i]));
+                if (dirty.to[i] >= 0)
+                    adds[addCount++] = column(featureIndex(p, kingSq, dirty.code[i], dirty.to[i]));
+            }
+            kernels.update(entries[ply].acc.values[p], entries[ply - 1].acc.values[p], adds, addCount, subs, subCount);
+            entries[ply].computed[p] = true;
+        }
+    }
+} // namespace Chess::NNUE
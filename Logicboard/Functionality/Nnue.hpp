@@ -0,0 +1,86 @@
+#pragma once
+#include "Chess.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Chess::NNUE {
+    // HalfKP: one input per (own king square, non-king piece, square), seen from each side's
+    // point of view with Black's squares mirrored. Kings are only the bucket, never an input.
+    constexpr int PIECE_KINDS = 10; // own pawn..queen, then the opponent's
+    constexpr int INPUTS = 64 * PIECE_KINDS * 64;
+    constexpr int HIDDEN = 256;
+
+    // Network file: a 64-byte header ("LBNN", version, INPUTS, HIDDEN as little-endian uint32,
+    // zero padding) followed by int16 feature weights [INPUTS][HIDDEN], int16 feature biases
+    // [HIDDEN], int16 output weights [2 * HIDDEN] (side to move first) and one int32 output bias.
+    constexpr uint32_t FILE_VERSION = 1;
+    constexpr int HEADER_BYTES = 64;
+    // Clipped ReLU ceiling of the hidden layer and the output quantisation
+    constexpr int QA = 255;
+    constexpr int QB = 64;
+    constexpr int OUTPUT_SCALE = 400;
+
+    // Memory-maps a network file, replacing any loaded one. False (nothing loaded) if the
+    // file is missing or its header does not match this build. Not safe while searching.
+    bool load(const std::string& path);
+    void unload();
+    bool isLoaded();
+
+    // Kernel sets, picked once from what the CPU reports; setSimd can only step down from there
+    enum class Simd { SCALAR, SSE41, AVX2 };
+    Simd detectedSimd();
+    Simd activeSimd();
+    void setSimd(Simd simd);
+    const char* simdName(Simd simd);
+
+    // Hidden layer before activation for both perspectives, [colorIndex]
+    struct alignas(64) Accumulator {
+        int16_t values[2][HIDDEN];
+    };
+
+    // The pieces a move puts down or picks up, read off the board before the move is made.
+    // A square of -1 means the piece appears (from) or disappears (to).
+    struct DirtyPieces {
+        int count = 0;
+        uint8_t code[3];
+        int8_t from[3];
+        int8_t to[3];
+    };
+    DirtyPieces dirtyPieces(const Board& board, PackedMove move);
+
+    void refresh(const Board& board, Accumulator& acc, PieceColor perspective);
+    // Score in centipawns from the side to move's point of view
+    int evaluate(const Board& board, const Accumulator& acc);
+
+    // Accumulators following the search's make/unmake, one per ply. push() only records what
+    // changed; current() brings the top up to date from the nearest computed ancestor, or
+    // rebuilds a perspective whose king has moved since, so nodes never evaluated cost nothing.
+    class AccumulatorStack {
+    public:
+        AccumulatorStack() : entries(CAPACITY) {}
+
+        void reset(const Board& board);
+        // After board.doMove(move), with the pieces dirtyPieces() read before it; empty for a null move
+        void push(const DirtyPieces& dirty) {
+            Entry& entry = entries[++top];
+            entry.dirty = dirty;
+            entry.computed[0] = entry.computed[1] = false;
+        }
+        void pop() { --top; }
+        const Accumulator& current(const Board& board);
+
+    private:
+        static constexpr int CAPACITY = 256;
+
+        struct Entry {
+            Accumulator acc;
+            DirtyPieces dirty;
+            bool computed[2];
+        };
+        std::vector<Entry> entries;
+        int top = 0;
+
+        void update(PieceColor perspective, const Board& board);
+    };
+} // namespace Chess::NNUE
@@ -0,0 +1,111 @@
+#include "Pawns.hpp"
+
+namespace Chess {
+    namespace {
+        constexpr Score DOUBLED{ -10, -25 };
+        constexpr Score ISOLATED{ -12, -16 };
+        constexpr Score BACKWARD{ -8, -12 };
+        // By rank counted from the pawn's own side
+        constexpr Score passedBonus[8] = { {0, 0}, {5, 10}, {10, 15}, {15, 30}, {25, 55}, {40, 90}, {70, 140}, {0, 0} };
+
+        // Own pawn one or two ranks in front of the king, or none at all, on each of the king's files
+        constexpr int SHELTER_NEAR = 15;
+        constexpr int SHELTER_FAR = 8;
+        constexpr int SHELTER_MISSING = -20;
+
+        constexpr Bitboard fileBB(int file) { return FILE_A_BB << file; }
+        constexpr Bitboard adjacentFilesBB(int file) {
+            return (file > 0 ? fileBB(file - 1) : 0) | (file < 7 ? fileBB(file + 1) : 0);
+        }
+        // Every square on the ranks in front of sq, as seen by the given side
+        constexpr Bitboard forwardRanksBB(int colorIdx, int sq) {
+            int rank = rankOf(sq);
+            if (colorIdx == 0)
+                return rank == 7 ? 0 : ~Bitboard(0) << (8 * (rank + 1));
+            return rank == 0 ? 0 : ~Bitboard(0) >> (8 * (8 - rank));
+        }
+
+        Score evaluateSide(const Board& board, PieceColor us, Bitboard& passed) {
+            int usIdx = colorIndex(us);
+            Bitboard ourPawns = board.pieces(us, PieceType::PAWN);
+            Bitboard theirPawns = board.pieces(opposite(us), PieceType::PAWN);
+            Score score;
+            passed = 0;
+
+            Bitboard b = ourPawns;
+            while (b) {
+                int sq = popLsb(b);
+                int file = fileOf(sq);
+                Bitboard ahead = forwardRanksBB(usIdx, sq);
+                Bitboard neighbours = ourPawns & adjacentFilesBB(file);
+
+                bool doubled = (ourPawns & ahead & fileBB(file)) != 0;
+                if (doubled)
+                    score += DOUBLED;
+                if (!neighbours)
+                    score += ISOLATED;
+                // No neighbour level with or behind it, and it cannot advance without being taken
+                else if (!(neighbours & ~ahead)) {
+                    int stop = usIdx == 0 ? sq + 8 : sq - 8;
+                    if (pawnAttacks(usIdx, stop) & theirPawns)
+                        score += BACKWARD;
+                }
+                // The rear pawn of a doubled pair is not counted as passed, the front one is
+                if (!doubled && !(theirPawns & ahead & (fileBB(file) | adjacentFilesBB(file)))) {
+                    passed |= squareBB(sq);
+                    score += passedBonus[usIdx == 0 ? rankOf(sq) : 7 - rankOf(sq)];
+                }
+            }
+            return score;
+        }
+    }
+
+    int PawnEntry::kingShelter(const Board& board, PieceColor color) {
+        int idx = colorIndex(color);
+        int king = board.kingSquareOf(color);
+        if (kingSquare[idx] == king)
+            return shelter[idx];
+
+        Bitboard ourPawns = board.pieces(color, PieceType::PAWN) & forwardRanksBB(idx, king);
+        int kingFile = fileOf(king);
+        int total = 0;
+        for (int file = kingFile > 0 ? kingFile - 1 : 0; file <= (kingFile < 7 ? kingFile + 1 : 7); ++file) {
+            Bitboard onFile = ourPawns & fileBB(file);
+            if (!onFile) {
+                total += SHELTER_MISSING;
+                continue;
+            }
+            // Closest pawn to the king on that file
+            int pawn = idx == 0 ? lsb(onFile) : 63 - std::countl_zero(onFile);
+            int distance = idx == 0 ? rankOf(pawn) - rankOf(king) : rankOf(king) - rankOf(pawn);
+            total += distance == 1 ? SHELTER_NEAR : distance == 2 ? SHELTER_FAR : 0;
+        }
+        kingSquare[idx] = static_cast<int8_t>(king);
+        shelter[idx] = total;
+        return total;
+    }
+
+    PawnEntry& PawnTable::probe(const Board& board) {
+        uint64_t key = board.pawnHash();
+        PawnEntry& entry = entries[key & (ENTRIES - 1)];
+        ++probes;
+        if (entry.key == key) {
+            ++hits;
+            return entry;
+        }
+
+        entry = PawnEntry();
+        entry.key = key;
+        Score white = evaluateSide(board, PieceColor::WHITE, entry.passed[0]);
+        Score black = evaluateSide(board, PieceColor::BLACK, entry.passed[1]);
+        entry.score = white - black;
+        return entry;
+    }
+
+    void PawnTable::clear() {
+        for (size_t i = 0; i < ENTRIES; ++i)
+            entries[i] = PawnEntry();
+        probes = 0;
+        hits = 0;
+    }
+} // namespace Chess
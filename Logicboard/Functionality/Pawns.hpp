@@ -0,0 +1,40 @@
+#pragma once
+#include "Chess.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Chess {
+    // Pawn structure of one position: everything that depends only on where the pawns stand,
+    // plus the king shelter for the last king square each side was seen on
+    struct PawnEntry {
+        uint64_t key = 0;
+        Score score;                   // doubled, isolated, backward and passed terms, White minus Black
+        Bitboard passed[2] = {};       // passed pawns by colorIndex()
+        int8_t kingSquare[2] = { -1, -1 };
+        int shelter[2] = {};           // midgame only, valid while the king stays on kingSquare
+
+        // Pawn cover in front of the side's king, recomputed only when the king has moved
+        int kingShelter(const Board& board, PieceColor color);
+    };
+
+    // Per-thread cache of pawn evaluations keyed by Board::pawnHash(). Pawn structures change
+    // far more rarely than positions, so most probes hit. Not shared, hence no locking.
+    class PawnTable {
+    public:
+        static constexpr size_t ENTRIES = 1 << 14;
+
+        PawnTable() : entries(std::make_unique<PawnEntry[]>(ENTRIES)) {}
+
+        // The entry for the board's pawns, evaluated on a miss. A zero key means no pawns
+        // at all, which an untouched entry already describes correctly.
+        PawnEntry& probe(const Board& board);
+        void clear();
+
+        uint64_t probes = 0;
+        uint64_t hits = 0;
+
+    private:
+        std::unique_ptr<PawnEntry[]> entries;
+    };
+} // namespace Chess
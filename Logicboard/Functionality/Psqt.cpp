@@ -0,0 +1,112 @@
+#include "Psqt.hpp"
+#include <mutex>
+
+namespace Chess::PSQT {
+    Score table[13][64];
+
+    namespace {
+        constexpr Score material[7] = { {0, 0}, {82, 94}, {337, 281}, {365, 297}, {477, 512}, {1025, 936}, {0, 0} };
+
+        // Square bonuses from White's side as the board is drawn, a8 first and h1 last
+        constexpr int pawnMg[64] = {
+              0,   0,   0,   0,   0,   0,   0,   0,
+             50,  50,  50,  50,  50,  50,  50,  50,
+             10,  10,  20,  30,  30,  20,  10,  10,
+              5,   5,  10,  25,  25,  10,   5,   5,
+              0,   0,   0,  20,  20,   0,   0,   0,
+              5,  -5, -10,   0,   0, -10,  -5,   5,
+              5,  10,  10, -20, -20,  10,  10,   5,
+              0,   0,   0,   0,   0,   0,   0,   0,
+        };
+        constexpr int pawnEg[64] = {
+              0,   0,   0,   0,   0,   0,   0,   0,
+             80,  80,  80,  80,  80,  80,  80,  80,
+             50,  50,  50,  50,  50,  50,  50,  50,
+             30,  30,  30,  30,  30,  30,  30,  30,
+             20,  20,  20,  20,  20,  20,  20,  20,
+             10,  10,  10,  10,  10,  10,  10,  10,
+             10,  10,  10,  10,  10,  10,  10,  10,
+              0,   0,   0,   0,   0,   0,   0,   0,
+        };
+        constexpr int knight[64] = {
+            -50, -40, -30, -30, -30, -30, -40, -50,
+            -40, -20,   0,   0,   0,   0, -20, -40,
+            -30,   0,  10,  15,  15,  10,   0, -30,
+            -30,   5,  15,  20,  20,  15,   5, -30,
+            -30,   0,  15,  20,  20,  15,   0, -30,
+            -30,   5,  10,  15,  15,  10,   5, -30,
+            -40, -20,   0,   5,   5,   0, -20, -40,
+            -50, -40, -30, -30, -30, -30, -40, -50,
+        };
+        constexpr int bishop[64] = {
+            -20, -10, -10, -10, -10, -10, -10, -20,
+            -10,   0,   0,   0,   0,   0,   0, -10,
+            -10,   0,   5,  10,  10,   5,   0, -10,
+            -10,   5,   5,  10,  10,   5,   5, -10,
+            -10,   0,  10,  10,  10,  10,   0, -10,
+            -10,  10,  10,  10,  10,  10,  10, -10,
+            -10,   5,   0,   0,   0,   0,   5, -10,
+            -20, -10, -10, -10, -10, -10, -10, -20,
+        };
+        constexpr int rook[64] = {
+              0,   0,   0,   0,   0,   0,   0,   0,
+              5,  10,  10,  10,  10,  10,  10,   5,
+             -5,   0,   0,   0,   0,   0,   0,  -5,
+             -5,   0,   0,   0,   0,   0,   0,  -5,
+             -5,   0,   0,   0,   0,   0,   0,  -5,
+             -5,   0,   0,   0,   0,   0,   0,  -5,
+             -5,   0,   0,   0,   0,   0,   0,  -5,
+              0,   0,   0,   5,   5,   0,   0,   0,
+        };
+        constexpr int queen[64] = {
+            -20, -10, -10,  -5,  -5, -10, -10, -20,
+            -10,   0,   0,   0,   0,   0,   0, -10,
+            -10,   0,   5,   5,   5,   5,   0, -10,
+             -5,   0,   5,   5,   5,   5,   0,  -5,
+              0,   0,   5,   5,   5,   5,   0,  -5,
+            -10,   5,   5,   5,   5,   5,   0, -10,
+            -10,   0,   5,   0,   0,   0,   0, -10,
+            -20, -10, -10,  -5,  -5, -10, -10, -20,
+        };
+        // The king hides behind its pawns while queens are on, and walks to the centre once they are off
+        constexpr int kingMg[64] = {
+            -30, -40, -40, -50, -50, -40, -40, -30,
+            -30, -40, -40, -50, -50, -40, -40, -30,
+            -30, -40, -40, -50, -50, -40, -40, -30,
+            -30, -40, -40, -50, -50, -40, -40, -30,
+            -20, -30, -30, -40, -40, -30, -30, -20,
+            -10, -20, -20, -20, -20, -20, -20, -10,
+             20,  20,   0,   0,   0,   0,  20,  20,
+             20,  30,  10,   0,   0,  10,  30,  20,
+        };
+        constexpr int kingEg[64] = {
+            -50, -40, -30, -20, -20, -30, -40, -50,
+            -30, -20, -10,   0,   0, -10, -20, -30,
+            -30, -10,  20,  30,  30,  20, -10, -30,
+            -30, -10,  30,  40,  40,  30, -10, -30,
+            -30, -10,  30,  40,  40,  30, -10, -30,
+            -30, -10,  20,  30,  30,  20, -10, -30,
+            -30, -30,   0,   0,   0,   0, -30, -30,
+            -50, -30, -30, -30, -30, -30, -30, -50,
+        };
+
+        // [PieceType] midgame and endgame tables; pieces other than pawn and king use one for both
+        constexpr const int* mgTables[7] = { nullptr, pawnMg, knight, bishop, rook, queen, kingMg };
+        constexpr const int* egTables[7] = { nullptr, pawnEg, knight, bishop, rook, queen, kingEg };
+    }
+
+    void init() {
+        static std::once_flag once;
+        std::call_once(once, [] {
+            for (int type = 1; type <= 6; ++type) {
+                for (int sq = 0; sq < 64; ++sq) {
+                    // The tables are drawn rank 8 first: White reads them rank-flipped, Black as they are
+                    int whiteIdx = sq ^ 56;
+                    int blackIdx = sq;
+                    table[type][sq] = material[type] + Score{ mgTables[type][whiteIdx], egTables[type][whiteIdx] };
+                    table[type + 6][sq] = -(material[type] + Score{ mgTables[type][blackIdx], egTables[type][blackIdx] });
+                }
+            }
+        });
+    }
+} // namespace Chess::PSQT
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+
+namespace Chess {
+    // Midgame and endgame halves of an evaluation term, blended by game phase only at the end
+    struct Score {
+        int mg = 0;
+        int eg = 0;
+
+        constexpr Score& operator+=(Score other) { mg += other.mg; eg += other.eg; return *this; }
+        constexpr Score& operator-=(Score other) { mg -= other.mg; eg -= other.eg; return *this; }
+        constexpr Score operator+(Score other) const { return { mg + other.mg, eg + other.eg }; }
+        constexpr Score operator-(Score other) const { return { mg - other.mg, eg - other.eg }; }
+        constexpr Score operator-() const { return { -mg, -eg }; }
+        constexpr bool operator==(const Score& other) const { return mg == other.mg && eg == other.eg; }
+    };
+
+    namespace PSQT {
+        // Material plus square bonus per piece code and square, positive for White and negative
+        // for Black, so Board can keep one running White-minus-Black sum; index 0 stays zero
+        extern Score table[13][64];
+
+        // Game phase contributed by each PieceType; the full starting set adds up to MAX_PHASE
+        constexpr int phaseWeight[7] = { 0, 0, 1, 1, 2, 4, 0 };
+        constexpr int MAX_PHASE = 24;
+
+        // Fills the table, safe to call more than once
+        void init();
+    }
+} // namespace Chess
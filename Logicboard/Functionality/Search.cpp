@@ -0,0 +1,666 @@
+#include "Search.hpp"
+#include "EvalCache.hpp"
+#include "Evaluation.hpp"
+#include "MovePicker.hpp"
+#include "Nnue.hpp"
+#include "TimeManager.hpp"
+#include "TranspositionTable.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace Chess {
+    namespace {
+        // How many nodes pass between looks at the clock and the stop flag, which keeps the
+        // clock read far off the per-node path
+        constexpr uint64_t CHECK_INTERVAL = 1024;
+
+        // Mate scores are stored relative to the node, so they stay right wherever the position recurs
+        int scoreToTT(int score, int ply) {
+            return score >= SCORE_MATE - MAX_PLY ? score + ply : score <= -SCORE_MATE + MAX_PLY ? score - ply : score;
+        }
+        int scoreFromTT(int score, int ply) {
+            return score >= SCORE_MATE - MAX_PLY ? score - ply : score <= -SCORE_MATE + MAX_PLY ? score + ply : score;
+        }
+
+        // Selective search margins, in centipawns and plies
+        constexpr int RFP_MAX_DEPTH = 6;
+        constexpr int RFP_MARGIN = 90;          // per ply of remaining depth
+        constexpr int FUTILITY_MAX_DEPTH = 3;
+        constexpr int futilityMargin[FUTILITY_MAX_DEPTH + 1] = { 0, 150, 300, 500 };
+        constexpr int NULL_MOVE_MIN_DEPTH = 3;
+        constexpr int NULL_MOVE_VERIFY_DEPTH = 10; // null-move cutoffs from here up are verified
+        constexpr int LMR_MIN_DEPTH = 3;
+
+        // Late move reductions by [depth][moveNumber], growing with the log of both
+        struct ReductionTable {
+            int8_t table[64][64] = {};
+            ReductionTable() {
+                for (int depth = 1; depth < 64; ++depth)
+                    for (int moveNumber = 1; moveNumber < 64; ++moveNumber)
+                        table[depth][moveNumber] = static_cast<int8_t>(0.75 + std::log(depth) * std::log(moveNumber) / 2.25);
+            }
+        };
+        const ReductionTable lmrTable;
+        const auto& lmrReductions = lmrTable.table;
+
+        // Zugzwang guard for null move: with only king and pawns left, passing is often the best move
+        bool hasNonPawnMaterial(const Board& board, PieceColor color) {
+            return board.pieces(color, PieceType::KNIGHT) | board.pieces(color, PieceType::BISHOP)
+                | board.pieces(color, PieceType::ROOK) | board.pieces(color, PieceType::QUEEN);
+        }
+
+        bool isLegal(const Board& board, PackedMove move) {
+            MoveList moves;
+            board.generateLegalMoves(moves);
+            for (PackedMove legal : moves) {
+                if (legal == move)
+                    return true;
+            }
+            return false;
+        }
+
+        // Lazy SMP depth staggering: helper i skips depth d when ((d + phase) / size) is odd,
+        // so consecutive helpers cover alternating depths with different periods
+        constexpr int SKIP_PATTERNS = 20;
+        constexpr int skipSize[SKIP_PATTERNS] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+        constexpr int skipPhase[SKIP_PATTERNS] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+        // Per-thread search state, reused from one search to the next. Index 0 is the main
+        // thread: the only one that enforces limits and whose result is reported.
+        class Searcher {
+        public:
+            Searcher(int index, const std::atomic<bool>& stopRequested, const std::atomic<bool>& pondering,
+                std::atomic<uint64_t>& totalNodes, TripleBuffer<AnalysisSnapshot>& snapshots)
+                : index(index), stopRequested(stopRequested), pondering(pondering), totalNodes(totalNodes), snapshots(snapshots) {
+            }
+
+            void setup(const Board& root, const SearchLimits& searchLimits, const SearchOptions& searchOptions, bool ponder) {
+                board = root;
+                limits = searchLimits;
+                options = searchOptions;
+                nullMoveMinPly = 0;
+                useNnue = options.nnue && NNUE::isLoaded();
+                if (useNnue)
+                    accumulators.reset(board);
+                MoveList rootMoves;
+                board.generateLegalMoves(rootMoves);
+                time.start(limits, static_cast<int>(rootMoves.size()), ponder);
+                rootMoveNodes.fill(0);
+                nodes = 0;
+                cutoffs = 0;
+                firstMoveCutoffs = 0;
+                evalProbes = 0;
+                evalHits = 0;
+                stopped = false;
+                ordering.age();
+                if (index == 0) {
+                    // Nothing from the previous search may show while this one finishes its first iteration
+                    snapshots.back() = AnalysisSnapshot();
+                    snapshots.back().sideToMove = board.currentTurn;
+                    snapshots.publish();
+                }
+            }
+            SearchResult iterate();
+            uint64_t betaCutoffs() const { return cutoffs; }
+            uint64_t firstMoveBetaCutoffs() const { return firstMoveCutoffs; }
+            uint64_t evalCacheProbes() const { return evalProbes; }
+            uint64_t evalCacheHits() const { return evalHits; }
+
+        private:
+            int index;
+            Board board;
+            SearchLimits limits;
+            SearchOptions options;
+            const std::atomic<bool>& stopRequested;
+            const std::atomic<bool>& pondering; // cleared by ponderhit()
+            std::atomic<uint64_t>& totalNodes; // every thread's nodes, flushed each CHECK_INTERVAL
+            TripleBuffer<AnalysisSnapshot>& snapshots;
+            TimeManager time;
+            uint64_t nodes = 0;
+            std::array<uint64_t, 64 * 64> rootMoveNodes; // nodes below each root move, by from and to square
+            // Root moves already given a line this iteration, which the next line must leave out
+            PackedMove excludedRoot[MAX_MULTI_PV];
+            int excludedCount = 0;
+            uint64_t cutoffs = 0;
+            uint64_t firstMoveCutoffs = 0;
+            uint64_t evalProbes = 0;
+            uint64_t evalHits = 0;
+            bool stopped = false;
+            int nullMoveMinPly = 0; // no null move above this ply while a null-move cutoff is verified
+            OrderingTables ordering;
+            PawnTable pawns;
+            NNUE::AccumulatorStack accumulators;
+            bool useNnue = false;
+
+            // Triangular PV table: pv[ply] holds the best line found from that ply on
+            PackedMove pv[MAX_PLY][MAX_PLY];
+            int pvLength[MAX_PLY] = {};
+
+            // Every move inside the tree goes through these, so the accumulators follow the board
+            void makeMove(PackedMove move) {
+                if (useNnue) {
+                    NNUE::DirtyPieces dirty = NNUE::dirtyPieces(board, move);
+                    board.doMove(move);
+                    accumulators.push(dirty);
+                }
+                else
+                    board.doMove(move);
+            }
+            void unmakeMove() {
+                board.undoMove();
+                if (useNnue)
+                    accumulators.pop();
+            }
+            void makeNullMove() {
+                board.doNullMove();
+                if (useNnue)
+                    accumulators.push(NNUE::DirtyPieces());
+            }
+            void unmakeNullMove() {
+                board.undoNullMove();
+                if (useNnue)
+                    accumulators.pop();
+            }
+            // A transposition found in the eval cache skips a network inference, and the accumulator
+            // update with it, since the stack only catches up when it is asked for a score. The
+            // hand-written evaluation is cheaper than a cache miss, so it is never cached.
+            int staticEvaluation() {
+                if (!useNnue)
+                    return evaluate(board, pawns);
+                if (!options.evalCache)
+                    return NNUE::evaluate(board, accumulators.current(board));
+                int score;
+                ++evalProbes;
+                if (evalCache.probe(board.hashKey, score)) {
+                    ++evalHits;
+                    return score;
+                }
+                score = NNUE::evaluate(board, accumulators.current(board));
+                evalCache.store(board.hashKey, score);
+                return score;
+            }
+            bool checkStop();
+            bool isDraw() const;
+            bool isExcludedAtRoot(PackedMove move) const {
+                for (int i = 0; i < excludedCount; ++i)
+                    if (excludedRoot[i] == move)
+                        return true;
+                return false;
+            }
+            void publish(const SearchResult& result);
+            int negamax(int depth, int alpha, int beta, int ply);
+            int quiescence(int alpha, int beta, int ply);
+            std::vector<PackedMove> principalVariation(int depth);
+        };
+
+        bool Searcher::checkStop() {
+            uint64_t searched = totalNodes.fetch_add(CHECK_INTERVAL, std::memory_order_relaxed) + CHECK_INTERVAL;
+            if (stopRequested.load(std::memory_order_relaxed))
+                stopped = true;
+            else if (index == 0 && time.isPondering()) {
+                // On a ponder hit the time already spent counts, and may well be all this move needed
+                if (!pondering.load(std::memory_order_relaxed))
+                    stopped = time.ponderhit();
+            }
+            else if (index == 0 && ((limits.nodes && searched >= limits.nodes) || time.hardLimitReached()))
+                stopped = true;
+            return stopped;
+        }
+
+        // Fifty-move rule or a repetition of any position since the last irreversible move
+        bool Searcher::isDraw() const {
+            if (board.halfmoveClock >= 100)
+                return true;
+            int last = static_cast<int>(board.history.size());
+            for (int i = last - 2; i >= 0 && i >= last - board.halfmoveClock; i -= 2) {
+                if (board.history[i].hash == board.hashKey)
+                    return true;
+            }
+            return false;
+        }
+
+        int Searcher::negamax(int depth, int alpha, int beta, int ply) {
+            pvLength[ply] = 0;
+            if (++nodes % CHECK_INTERVAL == 0 && checkStop())
+                return 0;
+            if (ply > 0 && isDraw())
+                return 0;
+            if (ply >= MAX_PLY - 1)
+                return staticEvaluation();
+
+            bool inCheck = board.isChecked(board.currentTurn);
+            if (inCheck)
+                ++depth; // never stop the search while the king is attacked
+            if (depth <= 0)
+                return quiescence(alpha, beta, ply);
+
+            // Everything but the principal variation is searched with a null window after the
+            // first move, and only those nodes are pruned
+            bool pvNode = beta - alpha > 1;
+
+            // A deep enough stored result settles the node outright (never at the root, which needs a move)
+            TTEntry ttEntry;
+            bool ttHit = TT.probe(board.hashKey, ttEntry);
+            if (ttHit && ply > 0 && !pvNode && ttEntry.depth >= depth) {
+                int ttScore = scoreFromTT(ttEntry.score, ply);
+                if (ttEntry.bound == Bound::EXACT
+                    || (ttEntry.bound == Bound::LOWER && ttScore >= beta)
+                    || (ttEntry.bound == Bound::UPPER && ttScore <= alpha))
+                    return ttScore;
+            }
+
+            int staticEval = inCheck ? -SCORE_INFINITE : staticEvaluation();
+            bool prunable = !pvNode && !inCheck && !isMateScore(beta);
+
+            // Reverse futility: this far above beta, a few plies will not bring the score back down
+            if (options.reverseFutility && prunable && depth <= RFP_MAX_DEPTH
+                && staticEval - RFP_MARGIN * depth >= beta)
+                return staticEval;
+
+            // Null move: if passing still fails high, a real move will too. Never twice in a row,
+            // and never with only king and pawns, where having to move can be the losing part.
+            PackedMove previous = board.history.empty() ? PackedMove() : board.history.back().move;
+            if (options.nullMove && prunable && depth >= NULL_MOVE_MIN_DEPTH && ply >= nullMoveMinPly
+                && staticEval >= beta && !previous.isNull() && hasNonPawnMaterial(board, board.currentTurn)) {
+                int reduction = 3 + depth / 4;
+                makeNullMove();
+                int score = -negamax(depth - 1 - reduction, -beta, -beta + 1, ply + 1);
+                unmakeNullMove();
+                if (stopped)
+                    return 0;
+                if (score >= beta) {
+                    if (isMateScore(score))
+                        score = beta;
+                    if (depth < NULL_MOVE_VERIFY_DEPTH)
+                        return score;
+                    // Deep cutoffs are verified by a reduced search in which this side may not pass,
+                    // so a zugzwang that material alone does not reveal cannot prune a whole subtree
+                    int outerMinPly = nullMoveMinPly;
+                    nullMoveMinPly = ply + 3 * (depth - reduction) / 4;
+                    int verified = negamax(depth - reduction, beta - 1, beta, ply);
+                    nullMoveMinPly = outerMinPly;
+                    if (stopped)
+                        return 0;
+                    if (verified >= beta)
+                        return score;
+                }
+            }
+
+            MoveList moves;
+            board.generateLegalMoves(moves);
+            if (moves.empty())
+                return inCheck ? -SCORE_MATE + ply : 0;
+
+            // Futility: near the leaves, quiet moves cannot lift a hopeless static score to alpha
+            bool futile = options.futility && prunable && depth <= FUTILITY_MAX_DEPTH
+                && staticEval + futilityMargin[depth] <= alpha;
+
+            int originalAlpha = alpha;
+            int bestScore = -SCORE_INFINITE;
+            PackedMove bestMove;
+            MovePicker picker(board, moves, ttHit ? ttEntry.move : PackedMove(), ordering, ply);
+            PackedMove quietsTried[64];
+            int quietCount = 0;
+            int moveCount = 0;
+            for (PackedMove move = picker.next(); !move.isNull(); move = picker.next()) {
+                if (ply == 0 && isExcludedAtRoot(move))
+                    continue;
+                ++moveCount;
+                bool quiet = MovePicker::isQuiet(board, move);
+                uint64_t nodesBefore = nodes;
+                makeMove(move);
+                bool givesCheck = board.isChecked(board.currentTurn);
+                if (futile && quiet && !givesCheck && moveCount > 1) {
+                    unmakeMove();
+                    continue;
+                }
+
+                int score;
+                if (moveCount == 1) {
+                    score = -negamax(depth - 1, -beta, -alpha, ply + 1);
+                }
+                else {
+                    // Late quiet moves are searched shallower first and only re-searched at full
+                    // depth if they beat alpha anyway
+                    int reduction = 0;
+                    if (options.lateMoveReductions && depth >= LMR_MIN_DEPTH && quiet && !inCheck && !givesCheck) {
+                        reduction = lmrReductions[depth < 64 ? depth : 63][moveCount < 64 ? moveCount : 63];
+                        if (pvNode && reduction > 0)
+                            --reduction;
+                        if (reduction > depth - 2)
+                            reduction = depth - 2;
+                    }
+                    score = -negamax(depth - 1 - reduction, -alpha - 1, -alpha, ply + 1);
+                    if (score > alpha && reduction > 0)
+                        score = -negamax(depth - 1, -alpha - 1, -alpha, ply + 1);
+                    if (score > alpha && score < beta)
+                        score = -negamax(depth - 1, -beta, -alpha, ply + 1);
+                }
+                unmakeMove();
+                if (ply == 0)
+                    rootMoveNodes[move.from() | move.to() << 6] += nodes - nodesBefore;
+                if (stopped)
+                    return 0;
+
+                if (score > bestScore) {
+                    bestScore = score;
+                    if (score > alpha) {
+                        alpha = score;
+                        bestMove = move;
+                        pv[ply][0] = move;
+                        for (int j = 0; j < pvLength[ply + 1]; ++j)
+                            pv[ply][j + 1] = pv[ply + 1][j];
+                        pvLength[ply] = pvLength[ply + 1] + 1;
+                    }
+                }
+                if (score >= beta) {
+                    ++cutoffs;
+                    if (moveCount == 1)
+                        ++firstMoveCutoffs;
+                    if (quiet)
+                        ordering.updateQuiet(board, ply, depth, move, quietsTried, quietCount);
+                    break;
+                }
+                if (quiet && quietCount < 64)
+                    quietsTried[quietCount++] = move;
+            }
+            // Every move was pruned as futile except ones that scored nothing better
+            if (bestScore == -SCORE_INFINITE)
+                bestScore = alpha;
+
+            // A later multi-PV line's best move is not the root's, so it must not become the hash move
+            Bound bound = bestScore >= beta ? Bound::LOWER : alpha > originalAlpha ? Bound::EXACT : Bound::UPPER;
+            if (ply > 0 || excludedCount == 0)
+                TT.store(board.hashKey, bestMove, scoreToTT(bestScore, ply), depth, bound);
+            return bestScore;
+        }
+
+        // Captures and promotions only, so leaves are scored in quiet positions rather than
+        // halfway through an exchange. Captures SEE says lose material are not searched.
+        int Searcher::quiescence(int alpha, int beta, int ply) {
+            pvLength[ply] = 0;
+            if (++nodes % CHECK_INTERVAL == 0 && checkStop())
+                return 0;
+            if (ply >= MAX_PLY - 1)
+                return staticEvaluation();
+
+            // In check every evasion is searched and standing pat is not an option
+            bool inCheck = board.isChecked(board.currentTurn);
+            int bestScore = -SCORE_INFINITE;
+            if (!inCheck) {
+                bestScore = staticEvaluation();
+                if (bestScore >= beta)
+                    return bestScore;
+                if (bestScore > alpha)
+                    alpha = bestScore;
+            }
+
+            MoveList moves;
+            if (inCheck)
+                board.generateLegalMoves(moves);
+            else
+                board.generateLegalCaptures(moves);
+            if (inCheck && moves.empty())
+                return -SCORE_MATE + ply;
+
+            MovePicker picker = inCheck ? MovePicker(board, moves, PackedMove(), ordering, ply) : MovePicker(board, moves);
+            for (PackedMove move = picker.next(); !move.isNull(); move = picker.next()) {
+                makeMove(move);
+                int score = -quiescence(-beta, -alpha, ply + 1);
+                unmakeMove();
+                if (stopped)
+                    return 0;
+
+                if (score > bestScore) {
+                    bestScore = score;
+                    if (score > alpha) {
+                        alpha = score;
+                        if (score >= beta)
+                            break;
+                    }
+                }
+            }
+            return bestScore;
+        }
+
+        // The triangular table loses the tail of the line below table cutoffs, so it is
+        // continued with the stored best moves as long as they are legal
+        std::vector<PackedMove> Searcher::principalVariation(int depth) {
+            std::vector<PackedMove> line(pv[0], pv[0] + pvLength[0]);
+            for (PackedMove move : line)
+                board.doMove(move);
+            TTEntry entry;
+            while (static_cast<int>(line.size()) < depth && TT.probe(board.hashKey, entry)
+                && !entry.move.isNull() && isLegal(board, entry.move)) {
+                line.push_back(entry.move);
+                board.doMove(entry.move);
+            }
+            for (size_t i = 0; i < line.size(); ++i)
+                board.undoMove();
+            return line;
+        }
+
+        void Searcher::publish(const SearchResult& result) {
+            AnalysisSnapshot& snapshot = snapshots.back();
+            snapshot.depth = result.depth;
+            snapshot.nodes = totalNodes.load(std::memory_order_relaxed) + nodes % CHECK_INTERVAL;
+            snapshot.timeMs = time.elapsedMs();
+            snapshot.nps = snapshot.timeMs > 0 ? snapshot.nodes * 1000 / snapshot.timeMs : 0;
+            snapshot.sideToMove = board.currentTurn;
+            snapshot.lineCount = static_cast<int>(result.lines.size());
+            for (int i = 0; i < snapshot.lineCount; ++i) {
+                const PvLine& line = result.lines[i];
+                AnalysisSnapshot::Line& out = snapshot.lines[i];
+                out.score = line.score;
+                out.length = std::min(static_cast<int>(line.moves.size()), AnalysisSnapshot::MAX_MOVES);
+                std::copy(line.moves.begin(), line.moves.begin() + out.length, out.moves);
+            }
+            snapshots.publish();
+        }
+
+        SearchResult Searcher::iterate() {
+            SearchResult result;
+            MoveList rootMoves;
+            board.generateLegalMoves(rootMoves);
+            if (rootMoves.empty())
+                return result;
+            // Something legal to play even if the first iteration is cut short
+            result.bestMove = rootMoves[0];
+            int lineCount = std::clamp(options.multiPv, 1, std::min(MAX_MULTI_PV, static_cast<int>(rootMoves.size())));
+
+            for (int depth = 1; depth <= limits.depth && depth < MAX_PLY; ++depth) {
+                if (index > 0) {
+                    int pattern = (index - 1) % SKIP_PATTERNS;
+                    if (((depth + skipPhase[pattern]) / skipSize[pattern]) % 2)
+                        continue;
+                }
+                // Each further line searches the root again without the moves already reported
+                std::vector<PvLine> lines;
+                excludedCount = 0;
+                while (static_cast<int>(lines.size()) < lineCount) {
+                    int score = negamax(depth, -SCORE_INFINITE, SCORE_INFINITE, 0);
+                    if (stopped || stopRequested.load(std::memory_order_relaxed))
+                        break;
+                    lines.push_back({ score, principalVariation(depth) });
+                    if (lines.back().moves.empty())
+                        break;
+                    excludedRoot[excludedCount++] = lines.back().moves[0];
+                }
+                excludedCount = 0;
+                if (stopped || stopRequested.load(std::memory_order_relaxed))
+                    break;
+                // A later line can come out ahead once the earlier ones are searched deeper
+                std::stable_sort(lines.begin(), lines.end(), [](const PvLine& a, const PvLine& b) { return a.score > b.score; });
+                int score = lines[0].score;
+                result.depth = depth;
+                result.score = score;
+                result.pv = lines[0].moves;
+                result.lines = std::move(lines);
+                if (!result.pv.empty())
+                    result.bestMove = result.pv[0];
+                if (index == 0)
+                    publish(result);
+                // A mate inside the horizon cannot get any shorter by searching deeper
+                if (isMateScore(score) && SCORE_MATE - (score < 0 ? -score : score) <= depth)
+                    break;
+                if (index == 0) {
+                    double share = nodes ? static_cast<double>(rootMoveNodes[result.bestMove.from() | result.bestMove.to() << 6]) / nodes : 0;
+                    if (time.stopAfterIteration(result.bestMove, score, share))
+                        break;
+                }
+            }
+            totalNodes.fetch_add(nodes % CHECK_INTERVAL, std::memory_order_relaxed);
+            result.timeMs = time.elapsedMs();
+            return result;
+        }
+    }
+
+    struct Search::Pool {
+        std::mutex mutex;
+        std::condition_variable wakeUp;   // a new job was posted or the pool is shutting down
+        std::condition_variable finished; // a thread went idle
+        std::vector<std::thread> threads;
+        std::vector<std::unique_ptr<Searcher>> searchers;
+        std::atomic<uint64_t> totalNodes{ 0 };
+        uint64_t job = 0;
+        int busy = 0;
+        bool quit = false;
+    };
+
+    Search::Search(int threadCount) : pool(std::make_unique<Pool>()) {
+        setThreads(threadCount);
+    }
+
+    Search::~Search() {
+        abort();
+        shutdownPool();
+    }
+
+    void Search::shutdownPool() {
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            pool->quit = true;
+        }
+        pool->wakeUp.notify_all();
+        for (std::thread& thread : pool->threads)
+            thread.join();
+        pool->threads.clear();
+        pool->searchers.clear();
+        // New workers start with seenJob = 0, so they must not find an old job waiting
+        pool->job = 0;
+        pool->quit = false;
+    }
+
+    void Search::setThreads(int count) {
+        abort();
+        shutdownPool();
+        count = count < 1 ? 1 : count;
+        for (int i = 0; i < count; ++i)
+            pool->searchers.push_back(std::make_unique<Searcher>(i, stopRequested, pondering, pool->totalNodes, snapshots));
+        for (int i = 0; i < count; ++i)
+            pool->threads.emplace_back(&Search::workerLoop, this, i);
+    }
+
+    int Search::threads() const {
+        return static_cast<int>(pool->threads.size());
+    }
+
+    void Search::workerLoop(int index) {
+        uint64_t seenJob = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(pool->mutex);
+                pool->wakeUp.wait(lock, [&] { return pool->quit || pool->job != seenJob; });
+                if (pool->quit)
+                    return;
+                seenJob = pool->job;
+            }
+
+            SearchResult searched = pool->searchers[index]->iterate();
+            if (index == 0) {
+                // The main thread decides when the search is over and reports once the helpers are idle
+                stopRequested.store(true, std::memory_order_relaxed);
+                {
+                    std::unique_lock<std::mutex> lock(pool->mutex);
+                    pool->finished.wait(lock, [&] { return pool->busy == 1; });
+                }
+                searched.nodes = pool->totalNodes.load(std::memory_order_relaxed);
+                for (const auto& searcher : pool->searchers) {
+                    searched.cutoffs += searcher->betaCutoffs();
+                    searched.firstMoveCutoffs += searcher->firstMoveBetaCutoffs();
+                    searched.evalCacheProbes += searcher->evalCacheProbes();
+                    searched.evalCacheHits += searcher->evalCacheHits();
+                }
+                result = std::move(searched);
+                // Publish the result before clearing running, so a caller seeing !isRunning() can poll() it
+                resultReady.store(true, std::memory_order_release);
+                running.store(false, std::memory_order_release);
+            }
+            {
+                std::lock_guard<std::mutex> lock(pool->mutex);
+                --pool->busy;
+            }
+            pool->finished.notify_all();
+        }
+    }
+
+    void Search::start(const Board& board, const SearchLimits& limits) {
+        launch(board, limits, false);
+    }
+
+    void Search::ponder(const Board& board, PackedMove expectedReply, const SearchLimits& limits) {
+        Board predicted = board;
+        predicted.doMove(expectedReply);
+        launch(predicted, limits, true);
+    }
+
+    void Search::launch(const Board& board, const SearchLimits& limits, bool ponder) {
+        abort();
+        stopRequested.store(false, std::memory_order_relaxed);
+        pondering.store(ponder, std::memory_order_relaxed);
+        pool->totalNodes.store(0, std::memory_order_relaxed);
+        TT.newSearch();
+        for (auto& searcher : pool->searchers)
+            searcher->setup(board, limits, options, ponder);
+        running.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            pool->busy = static_cast<int>(pool->threads.size());
+            ++pool->job;
+        }
+        pool->wakeUp.notify_all();
+    }
+
+    void Search::wait() {
+        std::unique_lock<std::mutex> lock(pool->mutex);
+        pool->finished.wait(lock, [&] { return pool->busy == 0; });
+    }
+
+    void Search::abort() {
+        stop();
+        wait();
+        pondering.store(false, std::memory_order_relaxed);
+        resultReady.store(false, std::memory_order_relaxed);
+    }
+
+    bool Search::poll(SearchResult& out) {
+        if (!resultReady.load(std::memory_order_acquire))
+            return false;
+        out = std::move(result);
+        resultReady.store(false, std::memory_order_relaxed);
+        return true;
+    }
+
+    SearchResult Search::run(const Board& board, const SearchLimits& limits) {
+        start(board, limits);
+        wait();
+        SearchResult searched;
+        poll(searched);
+        return searched;
+    }
+} // namespace Chess
@@ -0,0 +1,168 @@
+#pragma once
+#include "Chess.hpp"
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace Chess {
+    constexpr int MAX_PLY = 128;
+    constexpr int SCORE_INFINITE = 32001;
+    constexpr int SCORE_MATE = 32000;   // mate at the root; mate in n plies scores SCORE_MATE - n
+
+    constexpr bool isMateScore(int score) { return score >= SCORE_MATE - MAX_PLY || score <= -SCORE_MATE + MAX_PLY; }
+
+    constexpr int MAX_MULTI_PV = 8;
+
+    // Any limit left at 0 is ignored; the search stops at whichever is reached first
+    struct SearchLimits {
+        int depth = MAX_PLY - 1;
+        uint64_t nodes = 0;
+        int64_t timeMs = 0;
+        // The side to move's clock. With time left set, the TimeManager budgets the move from it.
+        int64_t timeLeftMs = 0;
+        int64_t incrementMs = 0;
+        int movesToGo = 0; // moves until the next time control, 0 for the rest of the game
+    };
+
+    // Selective search features, each switchable on its own so their effect on nodes-to-depth
+    // and playing strength can be measured in isolation
+    struct SearchOptions {
+        bool nullMove = true;
+        bool lateMoveReductions = true;
+        bool futility = true;
+        bool reverseFutility = true;
+        // Evaluate with the NNUE network when one is loaded, otherwise the hand-written terms
+        bool nnue = true;
+        // Look NNUE scores up in the shared eval cache before running the network
+        bool evalCache = true;
+        // Root moves given a full line and score each iteration, best first (1 to MAX_MULTI_PV)
+        int multiPv = 1;
+    };
+
+    struct PvLine {
+        int score = 0;
+        std::vector<PackedMove> moves;
+    };
+
+    // Outcome of the deepest fully completed iteration
+    struct SearchResult {
+        PackedMove bestMove;
+        int score = 0;
+        int depth = 0;
+        uint64_t nodes = 0;
+        int64_t timeMs = 0;
+        std::vector<PackedMove> pv;
+        std::vector<PvLine> lines; // the multiPv best root moves, lines[0] being the one above
+        // Beta cutoffs over all threads and how many the first move tried produced:
+        // the ratio is the usual measure of move ordering quality
+        uint64_t cutoffs = 0;
+        uint64_t firstMoveCutoffs = 0;
+        // Static evaluations asked for over all threads and how many the eval cache answered
+        uint64_t evalCacheProbes = 0;
+        uint64_t evalCacheHits = 0;
+    };
+
+    // What the main thread reports after each completed iteration. Fixed size, so publishing
+    // one never allocates. Scores are from sideToMove's point of view.
+    struct AnalysisSnapshot {
+        static constexpr int MAX_MOVES = 24;
+        struct Line {
+            int score = 0;
+            int length = 0;
+            PackedMove moves[MAX_MOVES];
+        };
+        int depth = 0;
+        uint64_t nodes = 0;
+        uint64_t nps = 0;
+        int64_t timeMs = 0;
+        PieceColor sideToMove = PieceColor::WHITE;
+        int lineCount = 0;
+        Line lines[MAX_MULTI_PV];
+    };
+
+    // Hands values from one writer thread to one reader thread through three slots: the writer
+    // fills its own slot and swaps it for the shared one, the reader swaps the shared one for
+    // its own when it holds something newer. Neither side ever waits for the other.
+    template<typename T>
+    class TripleBuffer {
+    public:
+        // Writer side: fill back(), then publish() it
+        T& back() { return slots[backIndex]; }
+        void publish() { backIndex = shared.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK; }
+        // Reader side: the latest published value, valid until the next call
+        const T& latest() {
+            if (shared.load(std::memory_order_relaxed) & FRESH)
+                frontIndex = shared.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+            return slots[frontIndex];
+        }
+
+    private:
+        static constexpr int FRESH = 4;
+        static constexpr int INDEX_MASK = 3;
+        T slots[3];
+        int backIndex = 0;
+        int frontIndex = 1;
+        std::atomic<int> shared{ 2 };
+    };
+
+    // Negamax alpha-beta with iterative deepening, run as Lazy SMP: every pool thread searches
+    // the same root and they cooperate only through the shared transposition table. Helper
+    // threads skip some depths so they spread over several iterations at once; the result is
+    // always the main thread's. start() returns at once, so the render loop only ever calls
+    // the non-blocking isRunning()/poll(). Pool threads are created once and reused.
+    class Search {
+    public:
+        explicit Search(int threadCount = 1);
+        ~Search();
+        Search(const Search&) = delete;
+        Search& operator=(const Search&) = delete;
+
+        // Aborts any running search before rebuilding the pool
+        void setThreads(int count);
+        int threads() const;
+
+        // Applies from the next start() on
+        void setOptions(const SearchOptions& searchOptions) { options = searchOptions; }
+        const SearchOptions& getOptions() const { return options; }
+
+        void start(const Board& board, const SearchLimits& limits);
+        // Thinks on the opponent's time: searches board after expectedReply with no limit in force
+        // until ponderhit() says the reply was played and limits apply from then on. If another
+        // move comes, abort() drops the search, but what it stored in the transposition table stays.
+        void ponder(const Board& board, PackedMove expectedReply, const SearchLimits& limits);
+        void ponderhit() { pondering.store(false, std::memory_order_relaxed); }
+        bool isPondering() const { return pondering.load(std::memory_order_relaxed); }
+        // Asks a running search to finish; the last completed iteration is still delivered by poll()
+        void stop() { stopRequested.store(true, std::memory_order_relaxed); }
+        // Stops, waits for the workers and throws the result away, e.g. when the board is reset
+        void abort();
+        bool isRunning() const { return running.load(std::memory_order_acquire); }
+        // Hands over a finished search's result exactly once, never blocks
+        bool poll(SearchResult& result);
+        // Blocks until every pool thread is idle again
+        void wait();
+
+        // start() followed by wait(), for tools and benchmarks
+        SearchResult run(const Board& board, const SearchLimits& limits);
+
+        // The running or last search's report for its latest completed depth. Lock-free and for one
+        // reader thread only, so the UI can call it every frame while the search threads work.
+        const AnalysisSnapshot& analysis() { return snapshots.latest(); }
+
+    private:
+        struct Pool;
+        std::unique_ptr<Pool> pool;
+        std::atomic<bool> running{ false };
+        std::atomic<bool> resultReady{ false };
+        std::atomic<bool> stopRequested{ false };
+        std::atomic<bool> pondering{ false };
+        SearchOptions options;
+        SearchResult result; // written by the main thread before resultReady is released
+        TripleBuffer<AnalysisSnapshot> snapshots; // written by the main search thread only
+
+        void launch(const Board& board, const SearchLimits& limits, bool ponder);
+        void workerLoop(int index);
+        void shutdownPool();
+    };
+} // namespace Chess
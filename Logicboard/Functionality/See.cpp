@@ -0,0 +1,89 @@
+#include "Chess.hpp"
+#include "Evaluation.hpp"
+using namespace Chess;
+
+namespace {
+    // Exchange value per PieceType; the king only matters in that it cannot be recaptured
+    constexpr int seeValues[7] = { 0, pieceValues[1], pieceValues[2], pieceValues[3], pieceValues[4], pieceValues[5], 20000 };
+
+    inline int seeValue(uint8_t code) { return seeValues[static_cast<int>(codeType(code))]; }
+}
+
+// Swap-list algorithm: gain[d] is what the side making capture d stands to win if the
+// sequence stopped right after it; the list is then folded back with each side free to
+// stop capturing whenever continuing would lose material. Pins are not taken into account.
+int Board::see(PackedMove move) const {
+    MoveType type = move.type();
+    if (type == MoveType::CASTLE)
+        return 0;
+
+    int from = move.from();
+    int to = move.to();
+    uint8_t mover = mailbox[from];
+    PieceColor side = codeColor(mover);
+
+    int gain[32];
+    int depth = 0;
+    Bitboard occ = occupied ^ squareBB(from);
+    int onSquare; // value of the piece now standing on the target square
+    if (type == MoveType::EN_PASSANT) {
+        occ ^= squareBB(makeSquare(fileOf(to), rankOf(from)));
+        gain[0] = seeValues[static_cast<int>(PieceType::PAWN)];
+        onSquare = seeValue(mover);
+    }
+    else if (type == MoveType::PROMOTION) {
+        int promoted = seeValues[static_cast<int>(move.promotion())];
+        gain[0] = seeValue(mailbox[to]) + promoted - seeValues[static_cast<int>(PieceType::PAWN)];
+        onSquare = promoted;
+    }
+    else {
+        gain[0] = seeValue(mailbox[to]);
+        onSquare = seeValue(mover);
+    }
+
+    Bitboard diagonal = pieces(PieceType::BISHOP) | pieces(PieceType::QUEEN);
+    Bitboard straight = pieces(PieceType::ROOK) | pieces(PieceType::QUEEN);
+    Bitboard attackers = attackersTo(to, occ) & occ;
+    side = opposite(side);
+
+    for (;;) {
+        Bitboard ours = attackers & colorBB[colorIndex(side)];
+        if (!ours)
+            break;
+
+        // Least valuable attacker
+        PieceType attacker = PieceType::PAWN;
+        Bitboard candidates = 0;
+        for (int t = static_cast<int>(PieceType::PAWN); t <= static_cast<int>(PieceType::KING); ++t) {
+            candidates = ours & pieces(side, static_cast<PieceType>(t));
+            if (candidates) {
+                attacker = static_cast<PieceType>(t);
+                break;
+            }
+        }
+        // The king may only take last, on a square the other side no longer covers
+        if (attacker == PieceType::KING && (attackers & colorBB[colorIndex(opposite(side))]))
+            break;
+
+        ++depth;
+        gain[depth] = onSquare - gain[depth - 1];
+        if (depth == 31)
+            break;
+
+        occ ^= squareBB(lsb(candidates));
+        // Removing the attacker may uncover a slider behind it
+        if (attacker == PieceType::PAWN || attacker == PieceType::BISHOP || attacker == PieceType::QUEEN)
+            attackers |= bishopAttacks(to, occ) & diagonal;
+        if (attacker == PieceType::ROOK || attacker == PieceType::QUEEN)
+            attackers |= rookAttacks(to, occ) & straight;
+        attackers &= occ;
+        onSquare = seeValues[static_cast<int>(attacker)];
+        side = opposite(side);
+    }
+
+    while (depth > 0) {
+        --depth;
+        gain[depth] = -(-gain[depth] > gain[depth + 1] ? -gain[depth] : gain[depth + 1]);
+    }
+    return gain[0];
+}
@@ -0,0 +1,70 @@
+#include "TimeManager.hpp"
+#include <algorithm>
+
+namespace Chess {
+    namespace {
+        // Kept back from every move for sending it over the network and for scheduling jitter
+        constexpr int64_t MOVE_OVERHEAD_MS = 30;
+        // Moves the remaining time is spread over when the clock gives no moves-to-go
+        constexpr int DEFAULT_MOVES_TO_GO = 30;
+        // The hard budget is this many soft budgets, but never more than this share of the clock
+        constexpr int64_t HARD_TO_SOFT = 5;
+        constexpr double HARD_CLOCK_SHARE = 0.75;
+        // Iterations completed before the best move's node share may cut the search short
+        constexpr int MIN_ITERATIONS_FOR_SHARE = 6;
+    }
+
+    void TimeManager::start(const SearchLimits& limits, int legalMoves, bool ponder) {
+        startTime = Clock::now();
+        pondering = ponder;
+        iterations = 0;
+        previousBest = PackedMove();
+        previousScore = 0;
+        bestMoveChanges = 0;
+        softMs = 0;
+        hardMs = limits.timeMs;
+        budgetMs = static_cast<double>(hardMs);
+        if (limits.timeLeftMs <= 0)
+            return;
+
+        int64_t available = std::max<int64_t>(1, limits.timeLeftMs - MOVE_OVERHEAD_MS);
+        int movesToGo = limits.movesToGo > 0 ? std::min(limits.movesToGo, DEFAULT_MOVES_TO_GO * 2) : DEFAULT_MOVES_TO_GO;
+        // The increment arrives after the move, so only most of it is spent in advance
+        softMs = available / movesToGo + limits.incrementMs * 3 / 4;
+        int64_t hard = std::min<int64_t>(softMs * HARD_TO_SOFT, static_cast<int64_t>(available * HARD_CLOCK_SHARE));
+        // The last move before the time control may use everything but the overhead
+        if (movesToGo == 1)
+            hard = available;
+        hard = std::max<int64_t>(1, hard);
+        softMs = std::clamp<int64_t>(softMs, 1, hard);
+        if (legalMoves == 1)
+            softMs = hard = std::min<int64_t>(hard, 10);
+        hardMs = limits.timeMs > 0 ? std::min(limits.timeMs, hard) : hard;
+        budgetMs = static_cast<double>(softMs);
+    }
+
+    bool TimeManager::ponderhit() {
+        pondering = false;
+        return budgetMs > 0 && elapsedMs() >= budgetMs;
+    }
+
+    bool TimeManager::stopAfterIteration(PackedMove bestMove, int score, double bestMoveShare) {
+        ++iterations;
+        bestMoveChanges = bestMoveChanges / 2 + (iterations > 1 && bestMove != previousBest ? 1 : 0);
+        int drop = iterations > 1 ? previousScore - score : 0;
+        previousBest = bestMove;
+        previousScore = score;
+        if (softMs == 0)
+            return false;
+
+        // A best move still changing between iterations needs more time to settle on one
+        double instability = 1.0 + bestMoveChanges;
+        // So does a score that just fell: the search has found a problem and looks for a way out
+        double scoreDrop = 1.0 + std::clamp(drop, 0, 100) / 200.0;
+        // A move that soaks up nearly all the nodes has beaten every alternative convincingly
+        double dominance = iterations >= MIN_ITERATIONS_FOR_SHARE ? std::clamp(1.6 - bestMoveShare, 0.5, 1.0) : 1.0;
+
+        budgetMs = std::min(softMs * instability * scoreDrop * dominance, static_cast<double>(hardMs));
+        return !pondering && elapsedMs() >= budgetMs;
+    }
+} // namespace Chess
@@ -0,0 +1,45 @@
+#pragma once
+#include "Search.hpp"
+#include <chrono>
+#include <cstdint>
+
+namespace Chess {
+    // Decides how long one move may take. From a game clock it derives a soft budget, checked
+    // between iterations and stretched or shrunk by how settled the search looks, and a hard
+    // budget the tree itself never overruns. The clock is only read when asked, which the search
+    // does every CHECK_INTERVAL nodes (see Search.cpp), never per node.
+    class TimeManager {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // Starts the clock for a search from limits; with a single legal reply there is nothing to think about.
+        // A ponder search runs free of every limit until ponderhit().
+        void start(const SearchLimits& limits, int legalMoves, bool ponder = false);
+        bool isPondering() const { return pondering; }
+        // The expected reply was played: limits apply from now on, with the time spent pondering
+        // counted as already used. True if that covers the budget and the search can answer at once.
+        bool ponderhit();
+        int64_t elapsedMs() const {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - startTime).count();
+        }
+        // For the in-tree check; stays false when the limits set no time at all
+        bool hardLimitReached() const { return !pondering && hardMs > 0 && elapsedMs() >= hardMs; }
+        // After each completed iteration of the main thread: whether starting another is worth it.
+        // bestMoveShare is the fraction of the root's nodes spent below bestMove so far.
+        bool stopAfterIteration(PackedMove bestMove, int score, double bestMoveShare);
+
+        int64_t softLimit() const { return softMs; }
+        int64_t hardLimit() const { return hardMs; }
+
+    private:
+        Clock::time_point startTime;
+        int64_t softMs = 0;
+        int64_t hardMs = 0;
+        double budgetMs = 0; // the soft budget as last adjusted by stopAfterIteration
+        bool pondering = false;
+        int iterations = 0;
+        PackedMove previousBest;
+        int previousScore = 0;
+        double bestMoveChanges = 0; // decays every iteration, so only recent changes count
+    };
+} // namespace Chess
@@ -0,0 +1,125 @@
+#include "TranspositionTable.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace Chess {
+    TranspositionTable TT;
+
+    namespace {
+        constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+        void* allocateTable(size_t bytes, bool hugePages) {
+#if defined(_WIN32)
+            (void)hugePages;
+            return _aligned_malloc(bytes, 64);
+#else
+            size_t alignment = hugePages && bytes >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : 64;
+            void* memory = std::aligned_alloc(alignment, (bytes + alignment - 1) / alignment * alignment);
+#ifdef __linux__
+            if (memory && alignment == HUGE_PAGE_SIZE)
+                madvise(memory, bytes, MADV_HUGEPAGE);
+#endif
+            return memory;
+#endif
+        }
+
+        void freeTable(void* memory) {
+#if defined(_WIN32)
+            _aligned_free(memory);
+#else
+            std::free(memory);
+#endif
+        }
+    }
+
+    TranspositionTable::~TranspositionTable() {
+        freeTable(buckets);
+    }
+
+    void TranspositionTable::resize(size_t megabytes, bool hugePages) {
+        size_t count = 1;
+        while (count * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024)
+            count *= 2;
+
+        // The old table is only released once the new one exists, so a failed resize throws
+        // with the previous table still intact and nothing left to free twice
+        size_t bytes = count * sizeof(Bucket);
+        Bucket* table = static_cast<Bucket*>(allocateTable(bytes, hugePages));
+        if (!table)
+            throw std::bad_alloc();
+        freeTable(buckets);
+        buckets = table;
+        allocatedBytes = bytes;
+        bucketCount = count;
+        clear();
+    }
+
+    void TranspositionTable::clear() {
+        // All-zero words are a valid empty entry: data 0 has Bound::NONE
+        std::memset(static_cast<void*>(buckets), 0, allocatedBytes);
+        generation = 0;
+    }
+
+    bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+        const Bucket& bucket = bucketFor(key);
+        for (const Entry& slot : bucket.entries) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if ((slot.check.load(std::memory_order_relaxed) ^ data) != key || boundOf(data) == Bound::NONE)
+                continue;
+            entry.move = PackedMove::fromRaw(static_cast<uint16_t>(data));
+            entry.score = static_cast<int16_t>(data >> 16);
+            entry.depth = depthOf(data);
+            entry.bound = boundOf(data);
+            return true;
+        }
+        return false;
+    }
+
+    void TranspositionTable::store(uint64_t key, PackedMove move, int score, int depth, Bound bound) {
+        Bucket& bucket = bucketFor(key);
+        Entry* victim = nullptr;
+        int victimWorth = 0;
+
+        for (Entry& slot : bucket.entries) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if ((slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+                // Same position: keep a deeper result from this search unless the new one is exact
+                if (bound != Bound::EXACT && generationOf(data) == generation && depthOf(data) > depth + 2)
+                    return;
+                if (move.isNull())
+                    move = PackedMove::fromRaw(static_cast<uint16_t>(data));
+                victim = &slot;
+                break;
+            }
+            // Otherwise evict the shallowest entry, counting each search of age as eight plies
+            int age = (generation - generationOf(data)) & GENERATION_MASK;
+            int worth = boundOf(data) == Bound::NONE ? -1024 : depthOf(data) - 8 * age;
+            if (!victim || worth < victimWorth) {
+                victim = &slot;
+                victimWorth = worth;
+            }
+        }
+
+        uint64_t data = pack(move, score, depth, bound, generation);
+        victim->check.store(key ^ data, std::memory_order_relaxed);
+        victim->data.store(data, std::memory_order_relaxed);
+    }
+
+    int TranspositionTable::hashfull() const {
+        constexpr size_t SAMPLE_BUCKETS = 250;
+        size_t sampled = bucketCount < SAMPLE_BUCKETS ? bucketCount : SAMPLE_BUCKETS;
+        int used = 0;
+        for (size_t i = 0; i < sampled; ++i) {
+            for (const Entry& slot : buckets[i].entries) {
+                uint64_t data = slot.data.load(std::memory_order_relaxed);
+                if (boundOf(data) != Bound::NONE && generationOf(data) == generation)
+                    ++used;
+            }
+        }
+        return static_cast<int>(used * 1000 / (sampled * ENTRIES_PER_BUCKET));
+    }
+} // namespace Chess
@@ -0,0 +1,79 @@
+#pragma once
+#include "Chess.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Chess {
+    // Which side of the window a stored score is known to lie on
+    enum class Bound : uint8_t { NONE = 0, UPPER, LOWER, EXACT };
+
+    // Decoded copy of a table entry, what probe() hands back
+    struct TTEntry {
+        PackedMove move;
+        int score = 0;
+        int depth = 0;
+        Bound bound = Bound::NONE;
+    };
+
+    // Shared hash table of search results keyed by Board::hash(). Each 64-byte bucket is one
+    // cache line of four entries. An entry is two 64-bit words, the packed data and key ^ data,
+    // so threads read and write without locks: a torn entry simply fails the key check.
+    class TranspositionTable {
+    public:
+        static constexpr size_t DEFAULT_MB = 16;
+
+        TranspositionTable() { resize(DEFAULT_MB); }
+        ~TranspositionTable();
+        TranspositionTable(const TranspositionTable&) = delete;
+        TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+        // Rounds down to a power-of-two number of buckets. With hugePages set, Linux is asked
+        // to back the table with transparent huge pages, cutting TLB misses on random probes.
+        // Not safe while a search is running.
+        void resize(size_t megabytes, bool hugePages = true);
+        void clear();
+        size_t sizeMb() const { return bucketCount * sizeof(Bucket) / (1024 * 1024); }
+
+        // Called once per search so entries from older searches are replaced first
+        void newSearch() { generation = (generation + 1) & GENERATION_MASK; }
+
+        bool probe(uint64_t key, TTEntry& entry) const;
+        void store(uint64_t key, PackedMove move, int score, int depth, Bound bound);
+        // Permille of sampled entries written during the current search
+        int hashfull() const;
+
+    private:
+        static constexpr int ENTRIES_PER_BUCKET = 4;
+        static constexpr uint8_t GENERATION_MASK = 0x3F;
+
+        struct Entry {
+            std::atomic<uint64_t> check; // key ^ data
+            std::atomic<uint64_t> data;  // move:16 | score:16 | depth:8 | bound:2 generation:6
+        };
+        struct alignas(64) Bucket {
+            Entry entries[ENTRIES_PER_BUCKET];
+        };
+        static_assert(sizeof(Bucket) == 64);
+
+        static uint64_t pack(PackedMove move, int score, int depth, Bound bound, uint8_t generation) {
+            return move.raw()
+                | (static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16)
+                | (static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 32)
+                | (static_cast<uint64_t>(static_cast<uint8_t>(bound) | (generation << 2)) << 40);
+        }
+        static int depthOf(uint64_t data) { return static_cast<int8_t>(data >> 32); }
+        static Bound boundOf(uint64_t data) { return static_cast<Bound>((data >> 40) & 3); }
+        static uint8_t generationOf(uint64_t data) { return static_cast<uint8_t>(data >> 42) & GENERATION_MASK; }
+
+        Bucket& bucketFor(uint64_t key) const { return buckets[key & (bucketCount - 1)]; }
+
+        Bucket* buckets = nullptr;
+        size_t bucketCount = 0;
+        size_t allocatedBytes = 0;
+        uint8_t generation = 0;
+    };
+
+    // The one table every search thread shares
+    extern TranspositionTable TT;
+} // namespace Chess
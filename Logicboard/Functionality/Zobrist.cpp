@@ -0,0 +1,32 @@
+#include "Zobrist.hpp"
+#include <mutex>
+
+namespace Chess::Zobrist {
+    uint64_t pieceSquare[13][64];
+    uint64_t side;
+    uint64_t castling[16];
+    uint64_t enPassant[8];
+
+    void init() {
+        static std::once_flag once;
+        std::call_once(once, [] {
+            // splitmix64 with a fixed seed, so keys are identical on every run and on both network peers
+            uint64_t state = 0x4C6F676963426F61ULL;
+            auto next = [&state] {
+                uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                return z ^ (z >> 31);
+            };
+            for (int code = 1; code < 13; ++code)
+                for (int sq = 0; sq < 64; ++sq)
+                    pieceSquare[code][sq] = next();
+            side = next();
+            for (uint64_t& key : castling)
+                key = next();
+            castling[0] = 0;
+            for (uint64_t& key : enPassant)
+                key = next();
+        });
+    }
+} // namespace Chess::Zobrist
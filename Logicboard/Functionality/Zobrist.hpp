@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+
+namespace Chess::Zobrist {
+    // Random keys XOR-ed together into Board::hash(); index 0 of pieceSquare is the empty square and stays 0
+    extern uint64_t pieceSquare[13][64];
+    extern uint64_t side;          // present when Black is to move
+    extern uint64_t castling[16];  // indexed by the castling rights bitmask
+    extern uint64_t enPassant[8];  // indexed by the en passant file
+
+    // Fills the tables from a fixed seed, safe to call more than once
+    void init();
+} // namespace Chess::Zobrist
@@ -12,10 +12,17 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "Functionality/Chess.hpp"
+#include "Functionality/Search.hpp"
+#include "Functionality/Nnue.hpp"
+#include "Functionality/Book.hpp"
 #include <string>
+#include <cstdio>
+#include <cstdlib>
 #include <optional>
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <mutex>
 #include <thread>
 const int GRID_SIZE = 8;
 float tileSize = 2.0f / GRID_SIZE;
@@ -24,23 +31,84 @@ std::thread networkingThread;
 std::thread discoveryThread;
 bool networkThreadActive = false;
 
+// The networking thread never touches the board or the engine: it leaves what it receives here
+// and the main loop applies it. Turns alternate, so a single slot holds every move in flight.
+std::mutex networkInboxMutex;
+std::optional<Chess::GameInfo> networkInbox;
+std::atomic<bool> networkConnected{ false }; // the peer connection stands and the game can begin
+
+void postFromNetwork(const Chess::GameInfo& gameInfo) {
+    std::lock_guard<std::mutex> lock(networkInboxMutex);
+    networkInbox = gameInfo;
+}
+
 std::unique_ptr<Renderer::ShaderRenderer> renderer;
 Networking::NetworkManager netMgr;
 
 Chess::Board chessBoard;
 
 std::vector<Renderer::VertexObject> tileVertexObjects;
-std::vector<std::unique_ptr<Chess::Piece>> takenPieces;
+std::vector<const Chess::Piece*> takenPieces;
 Renderer::VertexObject draggedPieceVertexObject;
 Chess::Position draggedFromPos;
 Chess::Position draggedToPos;
 bool isDragging = false;
 Chess::PieceColor localPlayerColor;
 
+// Computer opponent for local games; it thinks on its own thread and the frame loop only polls it
+Chess::Search engine;
+Chess::PieceColor engineColor = Chess::PieceColor::NONE;
+// The computer plays on a clock of its own, so it spends its time the way it would in a timed game
+constexpr int64_t ENGINE_CLOCK_MS = 3 * 60 * 1000;
+constexpr int64_t ENGINE_INCREMENT_MS = 2000;
+int64_t engineClockMs = ENGINE_CLOCK_MS;
+std::chrono::steady_clock::time_point engineTurnStart; // when the computer's clock last started running
+// Online the computer can play for the local player, thinking on the opponent's time about the reply it expects
+bool computerPlaysOnline = false;
+Chess::PackedMove ponderMove;
+bool playAgainstComputer = true;
+int engineThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+Chess::OpeningBook openingBook;
+
+// Analysis board for reviewing games: while no computer plays, the engine searches the shown
+// position without limit, and the left panel reads its multi-PV report every frame
+bool analysisMode = false;
+int analysisLines = 3;
+uint64_t analysedKey = 0; // position the running analysis is of, 0 when none runs
+int analysedLines = 0;
+
+void stopAnalysis() {
+    engine.abort();
+    Chess::SearchOptions options = engine.getOptions();
+    options.multiPv = 1;
+    engine.setOptions(options);
+    analysisMode = false;
+    analysedKey = 0;
+}
+
+// From White's point of view, in pawns or as moves to mate
+std::string formatScore(int score, Chess::PieceColor sideToMove) {
+    if (sideToMove == Chess::PieceColor::BLACK)
+        score = -score;
+    char text[16];
+    if (Chess::isMateScore(score))
+        std::snprintf(text, sizeof(text), "%s#%d", score > 0 ? "" : "-", (Chess::SCORE_MATE - std::abs(score) + 1) / 2);
+    else
+        std::snprintf(text, sizeof(text), "%+.2f", score / 100.0);
+    return text;
+}
+
+// The board is drawn from Black's side for the black player, so screen rows are mirrored
+inline Chess::Position toBoardPosition(Chess::Position screenPos) {
+    if (localPlayerColor == Chess::PieceColor::BLACK && screenPos.y >= 0)
+        return Chess::Position(screenPos.x, GRID_SIZE - 1 - screenPos.y);
+    return screenPos;
+}
+
 inline void drawDragging(int width, int height, double xpos, double ypos) {
     for (int y = 0; y < GRID_SIZE; y++) {
         for (int x = 0; x < GRID_SIZE; x++) {
-            Chess::Piece* piece = chessBoard.getPiece(x, y);
+            const Chess::Piece* piece = chessBoard.getPiece(x, y);
             if (piece->getType() == Chess::PieceType::EMPTY)
                 continue;
             if (x == draggedFromPos.x && y == draggedFromPos.y) {
@@ -59,27 +127,27 @@ inline void drawDragging(int width, int height, double xpos, double ypos) {
     }
 }
 
+// Main loop only, with what the networking thread posted
 void updateGameInfoFromNetwork(const Chess::GameInfo& gameInfo) {
+    // The expected reply turns the ponder search into the real one, already deep; any other
+    // move throws it away, though the transposition table keeps what it found
+    if (engine.isPondering()) {
+        engineTurnStart = std::chrono::steady_clock::now();
+        if (gameInfo.lastMove == ponderMove)
+            engine.ponderhit();
+        else
+            engine.abort();
+    }
+
+    // Moves travel in absolute board coordinates, so both peers apply them unchanged
+    chessBoard.applyMove(gameInfo.lastMove, takenPieces);
+
     chessBoard.currentTurn = gameInfo.currentTurn;
 
     chessBoard.gameState = gameInfo.gameState;
     if (chessBoard.gameState == Chess::GameState::PAUSED)
         chessBoard.gameState = Chess::GameState::ONGOING;
 
-    chessBoard.lastMove = gameInfo.lastMove;
-
-    auto& piece = chessBoard.grid[chessBoard.lastMove.from.x][GRID_SIZE - 1 - chessBoard.lastMove.from.y];
-
-    auto& dest = chessBoard.grid[chessBoard.lastMove.to.x][GRID_SIZE - 1 - chessBoard.lastMove.to.y];
-
-
-    if (chessBoard.lastMove.type == Chess::MoveType::CAPTURE)
-        takenPieces.push_back(std::move(dest));
-
-    dest = std::move(piece);
-    // Leave an empty piece at the original square
-    piece = std::make_unique<Chess::EmptyPiece>(&chessBoard);
-
     std::cout << "localPlayerColor=" << (localPlayerColor == Chess::PieceColor::WHITE ? "WHITE" : "BLACK")
         << ", currentTurn=" << (chessBoard.currentTurn == Chess::PieceColor::WHITE ? "WHITE" : "BLACK")
         << std::endl;
@@ -88,12 +156,14 @@ void updateGameInfoFromNetwork(const Chess::GameInfo& gameInfo) {
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
     if (chessBoard.gameState == Chess::GameState::PAUSED)
         return;
+    if (engineColor != Chess::PieceColor::NONE && engineColor == localPlayerColor) // the computer plays this side
+        return;
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
         double xpos, ypos;
         glfwGetCursorPos(window, &xpos, &ypos);
         int width, height;
         glfwGetFramebufferSize(window, &width, &height);
-        Chess::Position worldPos = screenToWorld(xpos, ypos, width, height, tileSize, GRID_SIZE);
+        Chess::Position worldPos = toBoardPosition(screenToWorld(xpos, ypos, width, height, tileSize, GRID_SIZE));
 
 
         // Check if the position is valid AND there is a piece
@@ -105,7 +175,6 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
                 draggedFromPos = worldPos;
                 draggedToPos = worldPos;
                 isDragging = true;
-                chessBoard.getPiece(worldPos.x, worldPos.y)->isVisible = false;
                 drawDragging(width, height, xpos, ypos);
             }
             else if (localPlayerColor == chessBoard.getPiece(worldPos.x, worldPos.y)->getColor()
@@ -114,7 +183,6 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
                 draggedFromPos = worldPos;
                 draggedToPos = worldPos;
                 isDragging = true;
-                chessBoard.getPiece(worldPos.x, worldPos.y)->isVisible = false;
                 drawDragging(width, height, xpos, ypos);
             }
 
@@ -128,8 +196,8 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
             return;
         isDragging = false;
         std::cout << "Releasing\n";
-        chessBoard.getPiece(draggedFromPos.x, draggedFromPos.y)->isVisible = true;
-        chessBoard.makeMove(draggedFromPos, draggedToPos, takenPieces);
+        if (chessBoard.makeMove(draggedFromPos, draggedToPos, takenPieces) && netMgr.isConnected())
+            netMgr.sendData<Chess::GameInfo>({ chessBoard.lastMove, chessBoard.gameState, chessBoard.currentTurn });
         draggedPieceVertexObject = renderer->setupQuad(0, 0, 0, 0);
         draggedFromPos = Chess::Position();
 		draggedToPos = Chess::Position();
@@ -144,7 +212,6 @@ void cursor_position_callback(GLFWwindow* window, double xpos, double ypos) {
 		return;
 
     if (chessBoard.gameState == Chess::GameState::PAUSED) {
-        chessBoard.getPiece(draggedFromPos.x, draggedFromPos.y)->isVisible = true;
         draggedPieceVertexObject = renderer->setupQuad(0, 0, 0, 0);
         draggedFromPos = Chess::Position();
         draggedToPos = Chess::Position();
@@ -152,7 +219,7 @@ void cursor_position_callback(GLFWwindow* window, double xpos, double ypos) {
 
     int width, height;
     glfwGetFramebufferSize(window, &width, &height);
-    Chess::Position worldPos = screenToWorld(xpos, ypos, width, height, tileSize, GRID_SIZE);
+    Chess::Position worldPos = toBoardPosition(screenToWorld(xpos, ypos, width, height, tileSize, GRID_SIZE));
     if (worldPos.x >= 0 && worldPos.y >= 0) {
         drawDragging(width,height,xpos,ypos);
         std::cout << "Dragging\n";
@@ -222,6 +289,13 @@ int main() {
         return -1;
     }
     glfwSwapInterval(1); // Enable vsync
+    engine.setThreads(engineThreads);
+    // Optional: without a network file next to the assets the engine keeps its hand-written evaluation
+    if (Chess::NNUE::load("Rendering/Assets/logicboard.nnue"))
+        std::cout << "NNUE loaded (" << Chess::NNUE::simdName(Chess::NNUE::activeSimd()) << ")\n";
+    // Optional as well: the computer plays from a Polyglot book while it has the position
+    if (openingBook.open("Rendering/Assets/book.bin"))
+        std::cout << "Opening book loaded (" << openingBook.size() << " entries)\n";
     Renderer::SetupImGuiStyle();
 
 
@@ -243,14 +317,6 @@ int main() {
                 : Vec3(115.0f / 255.0f, 149.0f / 255.0f, 82.0f / 255.0f);
 
             tileVertexObjects.push_back(renderer->setupColoredRect(xpos, ypos, tileSize, tileSize, color));
-
-            Chess::Piece* piece = chessBoard.getPiece(x, y);
-            if (piece->getType() == Chess::PieceType::EMPTY)
-                continue;
-            if (!piece->isVisible)
-                continue;
-
-            piece->vertexObject = renderer->setupQuad(xpos, ypos, tileSize, tileSize, retrievePath(piece).c_str());
         }
     }
 
@@ -261,6 +327,68 @@ int main() {
         glViewport(0, 0, width, height);
         glClear(GL_COLOR_BUFFER_BIT);
 
+        // --- Network --- (applied on this thread, which owns the board and the engine)
+        if (networkConnected.exchange(false)) {
+            if (localPlayerColor == Chess::PieceColor::BLACK) { // the joining side starts from a fresh board
+                chessBoard.resetBoard();
+                chessBoard.currentTurn = Chess::PieceColor::WHITE;
+            }
+            chessBoard.gameState = Chess::GameState::ONGOING;
+        }
+        std::optional<Chess::GameInfo> received;
+        {
+            std::lock_guard<std::mutex> lock(networkInboxMutex);
+            received.swap(networkInbox);
+        }
+        if (received)
+            updateGameInfoFromNetwork(*received);
+
+        // --- Computer opponent --- (isRunning before poll: a finished search publishes its result first)
+        if (engineColor != Chess::PieceColor::NONE && chessBoard.currentTurn == engineColor
+            && (chessBoard.gameState == Chess::GameState::ONGOING || chessBoard.gameState == Chess::GameState::CHECK)
+            && !engine.isRunning()) {
+            Chess::SearchResult result;
+            Chess::PackedMove move;
+            Chess::SearchLimits limits;
+            limits.timeLeftMs = engineClockMs;
+            limits.incrementMs = ENGINE_INCREMENT_MS;
+            if (engine.poll(result)) {
+                move = result.bestMove;
+                int64_t usedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - engineTurnStart).count();
+                engineClockMs = std::max<int64_t>(0, engineClockMs - usedMs) + ENGINE_INCREMENT_MS;
+                limits.timeLeftMs = engineClockMs;
+            }
+            else if ((move = openingBook.pick(chessBoard)).isNull()) { // out of book: think
+                engineTurnStart = std::chrono::steady_clock::now();
+                engine.start(chessBoard, limits);
+            }
+            if (!move.isNull()) {
+                chessBoard.applyMove(move, takenPieces);
+                chessBoard.updateGameState();
+                if (netMgr.isConnected()) {
+                    netMgr.sendData<Chess::GameInfo>({ chessBoard.lastMove, chessBoard.gameState, chessBoard.currentTurn });
+                    // The search's principal variation says which reply to think about meanwhile
+                    bool gameGoesOn = chessBoard.gameState == Chess::GameState::ONGOING || chessBoard.gameState == Chess::GameState::CHECK;
+                    if (gameGoesOn && result.pv.size() >= 2 && result.pv[0] == move) {
+                        ponderMove = result.pv[1];
+                        engine.ponder(chessBoard, ponderMove, limits);
+                    }
+                }
+            }
+        }
+
+        // --- Analysis --- (restarted whenever the position or the number of lines changes)
+        if (analysisMode && engineColor != Chess::PieceColor::NONE)
+            stopAnalysis(); // a game against the computer needs the engine
+        if (analysisMode && (chessBoard.hash() != analysedKey || analysisLines != analysedLines)) {
+            Chess::SearchOptions options = engine.getOptions();
+            options.multiPv = analysisLines;
+            engine.setOptions(options);
+            engine.start(chessBoard, Chess::SearchLimits());
+            analysedKey = chessBoard.hash();
+            analysedLines = analysisLines;
+        }
+
         // --- ImGui frame ---
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -303,8 +431,11 @@ int main() {
         ImGui::Text(chessBoard.currentTurn == localPlayerColor ?
             "Your turn!" : "Enemy's Turn!");
         if (ImGui::Button("Reset Board")) {
+            engine.abort();
+            analysedKey = 0;
             chessBoard.resetBoard();
             takenPieces.clear();
+            engineClockMs = ENGINE_CLOCK_MS;
         }
 
         ImGui::Separator();
@@ -314,6 +445,26 @@ int main() {
             chessBoard.gameState == Chess::GameState::CHECKMATE ? "Checkmate" :
             chessBoard.gameState == Chess::GameState::STALEMATE ? "Stalemate" : "Unknown");
 
+        if (engineColor == Chess::PieceColor::NONE) {
+            ImGui::Separator();
+            if (ImGui::Checkbox("Analyse position", &analysisMode) && !analysisMode)
+                stopAnalysis();
+            ImGui::SliderInt("Lines", &analysisLines, 1, Chess::MAX_MULTI_PV);
+            if (analysisMode) {
+                // Lock-free: the search threads never hold anything this waits for
+                const Chess::AnalysisSnapshot& snapshot = engine.analysis();
+                ImGui::Text("Depth %d  %.2f Mnps", snapshot.depth, snapshot.nps / 1e6);
+                ImGui::Text("%llu nodes  %.1fs", static_cast<unsigned long long>(snapshot.nodes), snapshot.timeMs / 1000.0);
+                for (int i = 0; i < snapshot.lineCount; ++i) {
+                    const Chess::AnalysisSnapshot::Line& line = snapshot.lines[i];
+                    std::string text = formatScore(line.score, snapshot.sideToMove);
+                    for (int m = 0; m < line.length; ++m)
+                        text += " " + Chess::moveToUci(line.moves[m]);
+                    ImGui::TextWrapped("%s", text.c_str());
+                }
+            }
+        }
+
         if (chessBoard.gameState == Chess::GameState::PAUSED) {
 
             ImGui::PushFont(ImGui::GetFont()); // use larger font if you have one loaded
@@ -322,24 +473,33 @@ int main() {
             ImGui::Separator();
 
 
+            ImGui::Checkbox("Play against computer", &playAgainstComputer);
+            ImGui::Checkbox("Computer plays online games", &computerPlaysOnline);
+            ImGui::SliderInt("Engine threads", &engineThreads, 1, std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+            if (ImGui::IsItemDeactivatedAfterEdit()) // rebuild the pool once the slider is released
+                engine.setThreads(engineThreads);
             if (ImGui::Button("Start Local Game", ImVec2(200, 50)))
             {
                 chessBoard.gameState = Chess::GameState::ONGOING;
-				localPlayerColor = Chess::PieceColor::NONE;
+                engineClockMs = ENGINE_CLOCK_MS;
+				localPlayerColor = playAgainstComputer ? Chess::PieceColor::WHITE : Chess::PieceColor::NONE;
+                engineColor = playAgainstComputer ? Chess::PieceColor::BLACK : Chess::PieceColor::NONE;
             }
 
             if (ImGui::Button("Host Online Game", ImVec2(200, 50)))
             {
 				networkThreadActive = true;
                 localPlayerColor = Chess::PieceColor::WHITE;
+                engineColor = computerPlaysOnline ? localPlayerColor : Chess::PieceColor::NONE;
+                engineClockMs = ENGINE_CLOCK_MS;
                 networkingThread = std::thread([&]() {
                     netMgr.startServer(4275);
-					chessBoard.gameState = Chess::GameState::ONGOING;
+                    networkConnected = true;
                     for(;;) {
 						if (!networkThreadActive)
 							break;
                         try {
-                            updateGameInfoFromNetwork(netMgr.receiveData<Chess::GameInfo>());
+                            postFromNetwork(netMgr.receiveData<Chess::GameInfo>());
                         }
                         catch (...) {
 
@@ -358,6 +518,8 @@ int main() {
             if (ImGui::Button("Join Online Game", ImVec2(200, 50))) {
 				networkThreadActive = true;
                 localPlayerColor = Chess::PieceColor::BLACK;
+                engineColor = computerPlaysOnline ? localPlayerColor : Chess::PieceColor::NONE;
+                engineClockMs = ENGINE_CLOCK_MS;
                 networkingThread = std::thread([&]() {
                     asio::io_context ioContext;
                     std::string serverIP = Networking::discoverServer(ioContext, 4275, 3000);
@@ -367,14 +529,12 @@ int main() {
                         return;
 					}
                     netMgr.startClient(std::string(serverIP), 4275);
-					chessBoard.resetBoard();
-					chessBoard.currentTurn = Chess::PieceColor::WHITE;
-					chessBoard.gameState = Chess::GameState::ONGOING;
+                    networkConnected = true;
                     for (;;) {
                         if(!networkThreadActive) 
 							break;
                         try {
-                            updateGameInfoFromNetwork(netMgr.receiveData<Chess::GameInfo>());
+                            postFromNetwork(netMgr.receiveData<Chess::GameInfo>());
                         }
                         catch (...) {
                         }
@@ -383,15 +543,23 @@ int main() {
             }
             if(ImGui::Button("Stop Network Activities", ImVec2(200, 50))) {
 				networkThreadActive = false;
+                engine.abort();
 			}
             ImGui::PopFont();
 
         }
         else {
+            if (engineColor != Chess::PieceColor::NONE)
+                ImGui::Text("Computer clock: %d:%02d", static_cast<int>(engineClockMs / 60000), static_cast<int>(engineClockMs / 1000 % 60));
+            if (engine.isRunning() && !analysisMode)
+                ImGui::Text("Computer is thinking...");
             if(ImGui::Button("Restart Game", ImVec2(200, 50))) {
+                engine.abort();
+                analysedKey = 0;
                 chessBoard.resetBoard();
 				chessBoard.gameState = Chess::GameState::ONGOING;
 				takenPieces.clear();
+                engineClockMs = ENGINE_CLOCK_MS;
 			}
         }
 
@@ -420,14 +588,16 @@ int main() {
                 float xpos = -1.0f + x * tileSize;
                 float ypos = -1.0f + y * tileSize;
 
-                Chess::Piece* piece = chessBoard.getPiece(x, y);
+                Chess::Position boardPos = toBoardPosition(Chess::Position(x, y));
+                const Chess::Piece* piece = chessBoard.getPiece(boardPos.x, boardPos.y);
                 if (piece->getType() == Chess::PieceType::EMPTY)
                     continue;
-                if (!piece->isVisible)
+                // The dragged piece is drawn under the cursor instead
+                if (isDragging && boardPos == draggedFromPos)
                     continue;
 
-                piece->vertexObject = renderer->setupQuad(xpos, ypos, tileSize, tileSize, retrievePath(piece).c_str());
-                renderer->render({ piece->vertexObject });
+                Renderer::VertexObject pieceVertexObject = renderer->setupQuad(xpos, ypos, tileSize, tileSize, retrievePath(piece).c_str());
+                renderer->render({ pieceVertexObject });
             }
         }
 
@@ -464,7 +634,7 @@ int main() {
                 blackIndex++;
             }
 
-            auto vobj = renderer->setupQuad(x, y, pieceDisplaySize, pieceDisplaySize, retrievePath(p.get()).c_str());
+            auto vobj = renderer->setupQuad(x, y, pieceDisplaySize, pieceDisplaySize, retrievePath(p).c_str());
             renderer->render({ vobj });
         }
 
@@ -0,0 +1,424 @@
+#include "../Logicboard/Functionality/Chess.hpp"
+#include "../Logicboard/Functionality/Search.hpp"
+#include "../Logicboard/Functionality/Book.hpp"
+#include "../Logicboard/Functionality/EvalCache.hpp"
+#include "../Logicboard/Functionality/Nnue.hpp"
+#include "../Logicboard/Functionality/TranspositionTable.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <cstdlib>
+#include <algorithm>
+
+// Headless move generator benchmark and correctness gate.
+//
+//   logicboard-perft [--depth N] [--fen "<fen>"] [--divide] [--threads N] [--hash MB]
+//   logicboard-perft --bench [--depth N] [--fen "<fen>"] [--hash MB] [--threads N]
+//                    [--no-nmp] [--no-lmr] [--no-futility] [--no-rfp] [--no-eval-cache] [--nnue <file>] [--simd avx2|sse4.1|scalar]
+//                    [--clock MS [--inc MS] [--movestogo N]] [--multipv N]
+//   logicboard-perft --book <file> [--fen "<fen>"]
+//
+// Without --fen the standard reference positions are run and checked against their
+// published node counts; the exit code is non-zero on any mismatch. --bench runs the
+// search to a fixed depth on the same positions and reports engine throughput instead;
+// with --threads it compares time-to-depth from one thread up to N. The --no-* switches turn
+// off null-move pruning, late move reductions, futility, reverse futility and the eval cache one at a time.
+// --nnue evaluates with a network file instead, and --simd caps its kernels below what the CPU offers.
+// --clock searches each position as if that much time were left on the clock instead of to a depth.
+// --multipv also searches and prints the N - 1 next best root moves of each position.
+// --book lists a Polyglot book's moves for the position (startpos by default) with the open and lookup times.
+
+namespace {
+    struct ReferencePosition {
+        const char* name;
+        const char* fen;
+        std::vector<uint64_t> nodes; // nodes[d - 1] is the count at depth d
+    };
+
+    const ReferencePosition referencePositions[] = {
+        { "startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            { 20, 400, 8902, 197281, 4865609, 119060324, 3195901860 } },
+        { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            { 48, 2039, 97862, 4085603, 193690690, 8031647685 } },
+        { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            { 14, 191, 2812, 43238, 674624, 11030083, 178633661 } },
+        { "position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            { 6, 264, 9467, 422333, 15833292, 706045033 } },
+        { "position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+            { 44, 1486, 62379, 2103487, 89941194 } },
+        { "position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+            { 46, 2079, 89890, 3894594, 164075551, 6923051137 } },
+    };
+
+    // Shared perft cache. Each slot stores key ^ count next to count, so a torn write
+    // from another thread simply fails verification instead of needing a lock.
+    class PerftTable {
+    public:
+        explicit PerftTable(size_t megabytes) {
+            size_t count = 1;
+            while (count * 2 * sizeof(Slot) <= megabytes * 1024 * 1024)
+                count *= 2;
+            slots = std::make_unique<Slot[]>(count);
+            mask = count - 1;
+        }
+
+        bool probe(uint64_t key, uint64_t& nodes) const {
+            const Slot& slot = slots[key & mask];
+            uint64_t check = slot.check.load(std::memory_order_relaxed);
+            uint64_t stored = slot.nodes.load(std::memory_order_relaxed);
+            if ((check ^ stored) != key)
+                return false;
+            nodes = stored;
+            return true;
+        }
+
+        void store(uint64_t key, uint64_t nodes) {
+            Slot& slot = slots[key & mask];
+            slot.check.store(key ^ nodes, std::memory_order_relaxed);
+            slot.nodes.store(nodes, std::memory_order_relaxed);
+        }
+
+    private:
+        struct Slot {
+            std::atomic<uint64_t> check{ 0 };
+            std::atomic<uint64_t> nodes{ 0 };
+        };
+        std::unique_ptr<Slot[]> slots;
+        size_t mask = 0;
+    };
+
+    inline uint64_t perftKey(uint64_t hash, int depth) {
+        return hash ^ (static_cast<uint64_t>(depth) * 0x9E3779B97F4A7C15ULL);
+    }
+
+    uint64_t perft(Chess::Board& board, int depth, PerftTable* table) {
+        Chess::MoveList moves;
+        board.generateLegalMoves(moves);
+        if (depth <= 1)
+            return depth == 1 ? moves.size() : 1;
+
+        uint64_t key = perftKey(board.hash(), depth);
+        uint64_t nodes = 0;
+        if (table && table->probe(key, nodes))
+            return nodes;
+
+        for (Chess::PackedMove move : moves) {
+            board.doMove(move);
+            nodes += perft(board, depth - 1, table);
+            board.undoMove();
+        }
+        if (table)
+            table->store(key, nodes);
+        return nodes;
+    }
+
+    struct PerftResult {
+        uint64_t nodes = 0;
+        double seconds = 0;
+        std::vector<std::pair<Chess::PackedMove, uint64_t>> divide;
+    };
+
+    // Root moves are handed out to the workers one at a time through a shared counter
+    PerftResult runPerft(const Chess::Board& root, int depth, int threadCount, PerftTable* table) {
+        PerftResult result;
+        auto start = std::chrono::steady_clock::now();
+
+        Chess::MoveList rootMoves;
+        root.generateLegalMoves(rootMoves);
+        std::vector<uint64_t> counts(rootMoves.size(), 0);
+        std::atomic<int> nextMove{ 0 };
+
+        auto worker = [&]() {
+            Chess::Board board(root);
+            for (int i = nextMove++; i < rootMoves.size(); i = nextMove++) {
+                board.doMove(rootMoves[i]);
+                counts[i] = depth > 1 ? perft(board, depth - 1, table) : 1;
+                board.undoMove();
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threadCount; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (std::thread& thread : pool)
+            thread.join();
+
+        for (int i = 0; i < rootMoves.size(); ++i) {
+            result.nodes += counts[i];
+            result.divide.emplace_back(rootMoves[i], counts[i]);
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    void printResult(int depth, const PerftResult& result, bool divide) {
+        if (divide) {
+            for (const auto& [move, nodes] : result.divide)
+                std::cout << "  " << Chess::moveToUci(move) << ": " << nodes << "\n";
+        }
+        double nps = result.seconds > 0 ? result.nodes / result.seconds : 0;
+        std::cout << "  depth " << depth << ": " << result.nodes << " nodes  "
+            << std::fixed << std::setprecision(3) << result.seconds << "s  "
+            << std::setprecision(1) << nps / 1e6 << " Mnps";
+    }
+
+    void printUsage() {
+        std::cout << "usage: logicboard-perft [--depth N] [--fen \"<fen>\"] [--divide] [--threads N] [--hash MB]\n"
+            << "       logicboard-perft --bench [--depth N] [--fen \"<fen>\"] [--hash MB] [--threads N]\n"
+            << "                        [--no-nmp] [--no-lmr] [--no-futility] [--no-rfp] [--no-eval-cache] [--nnue <file>] [--simd avx2|sse4.1|scalar]\n"
+            << "                        [--clock MS [--inc MS] [--movestogo N]] [--multipv N]\n"
+            << "       logicboard-perft --book <file> [--fen \"<fen>\"]\n";
+    }
+
+    int runBook(const std::string& path, const Chess::Board& board) {
+        using Clock = std::chrono::steady_clock;
+        auto microseconds = [](Clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); };
+
+        Chess::OpeningBook book;
+        auto start = Clock::now();
+        if (!book.open(path)) {
+            std::cerr << "Cannot open book: " << path << "\n";
+            return 2;
+        }
+        auto opened = Clock::now();
+        std::vector<Chess::OpeningBook::BookMove> moves;
+        book.probe(board, moves);
+        auto probed = Clock::now();
+
+        std::cout << "book: " << path << " (" << book.size() << " entries), key " << std::hex << std::setw(16) << std::setfill('0')
+            << Chess::OpeningBook::key(board) << std::dec << std::setfill(' ') << "\n"
+            << std::fixed << std::setprecision(1) << "  open " << microseconds(opened - start) << " us, probe "
+            << microseconds(probed - opened) << " us\n";
+        uint32_t total = 0;
+        for (const Chess::OpeningBook::BookMove& m : moves)
+            total += m.weight;
+        for (const Chess::OpeningBook::BookMove& m : moves)
+            std::cout << "  " << Chess::moveToUci(m.move) << "  weight " << m.weight
+                << "  (" << (total ? 100.0 * m.weight / total : 0) << "%)\n";
+        if (moves.empty())
+            std::cout << "  out of book\n";
+        return 0;
+    }
+
+    std::string pvToString(const std::vector<Chess::PackedMove>& pv) {
+        std::string line;
+        for (Chess::PackedMove move : pv)
+            line += (line.empty() ? "" : " ") + Chess::moveToUci(move);
+        return line;
+    }
+
+    struct BenchTotals {
+        uint64_t nodes = 0;
+        int64_t timeMs = 0;
+        uint64_t cutoffs = 0;
+        uint64_t firstMoveCutoffs = 0;
+        uint64_t evalCacheProbes = 0;
+        uint64_t evalCacheHits = 0;
+    };
+
+    // Share of beta cutoffs that came from the first move searched, or of evaluations the cache answered, in percent
+    double rate(uint64_t part, uint64_t whole) {
+        return whole > 0 ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+    }
+
+    // Search over a list of positions from an empty table, the engine throughput workload
+    BenchTotals benchPass(Chess::Search& search, const std::vector<Chess::Board>& boards, const Chess::SearchLimits& limits, bool verbose) {
+        BenchTotals totals;
+        Chess::TT.clear();
+        Chess::evalCache.clear();
+        for (size_t i = 0; i < boards.size(); ++i) {
+            Chess::SearchResult result = search.run(boards[i], limits);
+            totals.nodes += result.nodes;
+            totals.timeMs += result.timeMs;
+            totals.cutoffs += result.cutoffs;
+            totals.firstMoveCutoffs += result.firstMoveCutoffs;
+            totals.evalCacheProbes += result.evalCacheProbes;
+            totals.evalCacheHits += result.evalCacheHits;
+            if (verbose) {
+                std::cout << "position " << i + 1 << "  depth " << result.depth << "  score " << result.score
+                    << "  nodes " << result.nodes << "  " << result.timeMs << "ms  hashfull " << Chess::TT.hashfull()
+                    << "  first-move cutoffs " << std::fixed << std::setprecision(1)
+                    << rate(result.firstMoveCutoffs, result.cutoffs) << "%  eval cache hits "
+                    << rate(result.evalCacheHits, result.evalCacheProbes) << "%"
+                    << "  pv " << pvToString(result.pv) << "\n";
+                for (size_t line = 1; line < result.lines.size(); ++line)
+                    std::cout << "  line " << line + 1 << "  score " << result.lines[line].score
+                        << "  pv " << pvToString(result.lines[line].moves) << "\n";
+            }
+        }
+        return totals;
+    }
+
+    // With more than one thread, reports time-to-depth for 1, 2, 4, ... up to maxThreads threads
+    int runBench(const std::vector<std::string>& fens, const Chess::SearchLimits& limits, int maxThreads, const Chess::SearchOptions& options) {
+        std::vector<Chess::Board> boards(fens.size());
+        for (size_t i = 0; i < fens.size(); ++i) {
+            if (!boards[i].loadFen(fens[i])) {
+                std::cerr << "Invalid FEN: " << fens[i] << "\n";
+                return 2;
+            }
+        }
+
+        Chess::Search search;
+        search.setOptions(options);
+        if (maxThreads == 1) {
+            BenchTotals totals = benchPass(search, boards, limits, true);
+            std::cout << "bench: " << totals.nodes << " nodes  " << totals.timeMs << "ms  "
+                << (totals.timeMs > 0 ? totals.nodes * 1000 / totals.timeMs : 0) << " nps  first-move cutoffs "
+                << std::fixed << std::setprecision(1) << rate(totals.firstMoveCutoffs, totals.cutoffs) << "%  eval cache hits "
+                << rate(totals.evalCacheHits, totals.evalCacheProbes) << "%\n";
+            return 0;
+        }
+
+        std::vector<int> threadCounts;
+        for (int threads = 1; threads < maxThreads; threads *= 2)
+            threadCounts.push_back(threads);
+        threadCounts.push_back(maxThreads);
+
+        int64_t baselineMs = 0;
+        std::cout << "time to depth " << limits.depth << " over " << boards.size() << " positions\n";
+        for (int threads : threadCounts) {
+            search.setThreads(threads);
+            BenchTotals totals = benchPass(search, boards, limits, false);
+            if (threads == 1)
+                baselineMs = totals.timeMs;
+            std::cout << "  threads " << std::setw(3) << threads << ": " << std::setw(8) << totals.timeMs << "ms  "
+                << std::setw(12) << totals.nodes << " nodes  "
+                << std::setw(10) << (totals.timeMs > 0 ? totals.nodes * 1000 / totals.timeMs : 0) << " nps  speedup "
+                << std::fixed << std::setprecision(2) << (totals.timeMs > 0 ? static_cast<double>(baselineMs) / totals.timeMs : 0.0) << "\n";
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    int depth = 5;
+    bool depthGiven = false;
+    int threads = 1;
+    size_t hashMb = 0;
+    bool divide = false;
+    bool bench = false;
+    Chess::SearchOptions options;
+    std::string fen;
+    std::string nnuePath;
+    std::string simd;
+    std::string bookPath;
+    Chess::SearchLimits clock;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--depth" && hasValue) {
+            depth = std::max(1, std::atoi(argv[++i]));
+            depthGiven = true;
+        }
+        else if (arg == "--threads" && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--hash" && hasValue) hashMb = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        else if (arg == "--fen" && hasValue) fen = argv[++i];
+        else if (arg == "--divide") divide = true;
+        else if (arg == "--bench") bench = true;
+        else if (arg == "--no-nmp") options.nullMove = false;
+        else if (arg == "--no-lmr") options.lateMoveReductions = false;
+        else if (arg == "--no-futility") options.futility = false;
+        else if (arg == "--no-rfp") options.reverseFutility = false;
+        else if (arg == "--no-eval-cache") options.evalCache = false;
+        else if (arg == "--multipv" && hasValue) options.multiPv = std::clamp(std::atoi(argv[++i]), 1, Chess::MAX_MULTI_PV);
+        else if (arg == "--nnue" && hasValue) nnuePath = argv[++i];
+        else if (arg == "--simd" && hasValue) simd = argv[++i];
+        else if (arg == "--book" && hasValue) bookPath = argv[++i];
+        else if (arg == "--clock" && hasValue) clock.timeLeftMs = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--inc" && hasValue) clock.incrementMs = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--movestogo" && hasValue) clock.movesToGo = std::max(0, std::atoi(argv[++i]));
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (!bookPath.empty()) {
+        Chess::Board board;
+        if (!fen.empty() && !board.loadFen(fen)) {
+            std::cerr << "Invalid FEN: " << fen << "\n";
+            return 2;
+        }
+        return runBook(bookPath, board);
+    }
+
+    if (bench) {
+        std::vector<std::string> fens;
+        if (!fen.empty())
+            fens.push_back(fen);
+        else {
+            for (const ReferencePosition& position : referencePositions)
+                fens.push_back(position.fen);
+        }
+        if (hashMb > 0)
+            Chess::TT.resize(hashMb);
+        if (!nnuePath.empty()) {
+            if (!Chess::NNUE::load(nnuePath)) {
+                std::cerr << "Cannot load network: " << nnuePath << "\n";
+                return 2;
+            }
+            if (simd == "scalar")
+                Chess::NNUE::setSimd(Chess::NNUE::Simd::SCALAR);
+            else if (simd == "sse4.1")
+                Chess::NNUE::setSimd(Chess::NNUE::Simd::SSE41);
+            std::cout << "nnue: " << nnuePath << " (" << Chess::NNUE::simdName(Chess::NNUE::activeSimd()) << ")\n";
+        }
+        // On a clock the time manager ends each search unless a depth was asked for as well
+        Chess::SearchLimits limits = clock;
+        limits.depth = clock.timeLeftMs > 0 && !depthGiven ? Chess::MAX_PLY - 1 : depth;
+        return runBench(fens, limits, threads, options);
+    }
+
+    std::unique_ptr<PerftTable> table;
+    if (hashMb > 0)
+        table = std::make_unique<PerftTable>(hashMb);
+
+    Chess::Board board;
+    if (!fen.empty()) {
+        if (!board.loadFen(fen)) {
+            std::cerr << "Invalid FEN: " << fen << "\n";
+            return 2;
+        }
+        std::cout << fen << "\n";
+        printResult(depth, runPerft(board, depth, threads, table.get()), divide);
+        std::cout << "\n";
+        return 0;
+    }
+
+    int failures = 0;
+    uint64_t totalNodes = 0;
+    double totalSeconds = 0;
+    for (const ReferencePosition& position : referencePositions) {
+        board.loadFen(position.fen);
+        std::cout << position.name << "  " << position.fen << "\n";
+        PerftResult result = runPerft(board, depth, threads, table.get());
+        printResult(depth, result, divide);
+        totalNodes += result.nodes;
+        totalSeconds += result.seconds;
+
+        if (depth <= static_cast<int>(position.nodes.size())) {
+            uint64_t expected = position.nodes[depth - 1];
+            if (result.nodes == expected)
+                std::cout << "  OK\n";
+            else {
+                std::cout << "  FAIL (expected " << expected << ")\n";
+                ++failures;
+            }
+        }
+        else
+            std::cout << "  (no reference count)\n";
+    }
+
+    std::cout << "total: " << totalNodes << " nodes  " << std::fixed << std::setprecision(3) << totalSeconds << "s  "
+        << std::setprecision(1) << (totalSeconds > 0 ? totalNodes / totalSeconds / 1e6 : 0) << " Mnps, "
+        << threads << " thread(s)" << (table ? ", hash on" : "") << "\n";
+    return failures == 0 ? 0 : 1;
+}